@@ -17,6 +17,14 @@ SOURCES += \
     knight.cpp\
     piece.cpp\
     tile.cpp\
+    tbprobe.cpp\
+    tablebase.cpp\
+    perft.cpp\
+    search.cpp\
+    transposition.cpp\
+    movegen.cpp\
+    attacks.cpp\
+    position.cpp\
     raii.cpp
 
 
@@ -25,6 +33,18 @@ SOURCES += \
 HEADERS += \
     chesswindow.h\
     structure.h\
+    tbprobe.h\
+    tablebase.h\
+    perft.h\
+    scenarios.h\
+    search.h\
+    transposition.h\
+    zobrist.h\
+    movegen.h\
+    move.h\
+    attacks.h\
+    position.h\
+    bitboard.h\
     raii.h\
     utils.h
 
@@ -0,0 +1,187 @@
+#include "attacks.h"
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CHESSCORE_X86_64 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+config::Magic config::detail::rookMagics[64];
+config::RookBackend config::detail::rookBackend = config::RookBackend::Magic;
+
+namespace {
+    using namespace config;
+
+    // Sum over all squares of 2^(relevant occupancy bits).
+    constexpr int ROOK_TABLE_SIZE = 0x19000;
+    Bitboard rookTable[ROOK_TABLE_SIZE];
+
+    // Same layout, indexed by _pext_u64(occupancy, mask) instead of the magic product.
+    Bitboard rookPextTable[ROOK_TABLE_SIZE];
+    const Bitboard* rookPextAttacks[64];
+
+    bool detectPext()
+    {
+#if defined(CHESSCORE_X86_64) && defined(_MSC_VER)
+        int registers[4];
+        __cpuidex(registers, 7, 0);
+        return (registers[1] & (1 << 8)) != 0;
+#elif defined(CHESSCORE_X86_64)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("bmi2");
+#else
+        return false;
+#endif
+    }
+
+    const bool PEXT_SUPPORTED = detectPext();
+
+    // xorshift64* generator, deterministic so the tables are the same on every run
+    class MagicRandom {
+    public:
+        explicit MagicRandom(std::uint64_t seed) : state_(seed) {}
+
+        std::uint64_t next()
+        {
+            state_ ^= state_ >> 12;
+            state_ ^= state_ << 25;
+            state_ ^= state_ >> 27;
+            return state_ * 2685821657736338717ULL;
+        }
+
+        std::uint64_t sparse()
+        {
+            return next() & next() & next();
+        }
+
+    private:
+        std::uint64_t state_;
+    };
+
+    // The last square of each ray never hides anything, so it is left out of the mask.
+    Bitboard relevantRookOccupancy(Square square)
+    {
+        Bitboard mask = EMPTY_BITBOARD;
+        const int x = squareX(square);
+        const int y = squareY(square);
+
+        for (int i = x + 1; i < 7; ++i) mask |= squareBit(makeSquare(i, y));
+        for (int i = x - 1; i > 0; --i) mask |= squareBit(makeSquare(i, y));
+        for (int j = y + 1; j < 7; ++j) mask |= squareBit(makeSquare(x, j));
+        for (int j = y - 1; j > 0; --j) mask |= squareBit(makeSquare(x, j));
+        return mask;
+    }
+
+    void initRookMagics()
+    {
+        static const std::uint64_t SEEDS[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+
+        Bitboard occupancies[4096];
+        Bitboard references[4096];
+        int epoch[4096] = {};
+        int attempt = 0;
+        Bitboard* table = rookTable;
+        Bitboard* pextTable = rookPextTable;
+
+        for (Square square = 0; square < 64; ++square) {
+            Magic& magic = detail::rookMagics[square];
+            magic.mask = relevantRookOccupancy(square);
+            magic.shift = 64 - popCount(magic.mask);
+            magic.attacks = table;
+
+            // Carry-Rippler enumeration of every subset of the mask, in increasing
+            // order of its pext index
+            int size = 0;
+            Bitboard subset = EMPTY_BITBOARD;
+            do {
+                occupancies[size] = subset;
+                references[size] = slidingRookAttacks(square, subset);
+                if (PEXT_SUPPORTED)
+                    pextTable[size] = references[size];
+                ++size;
+                subset = (subset - magic.mask) & magic.mask;
+            } while (subset);
+
+            rookPextAttacks[square] = pextTable;
+            pextTable += size;
+
+            MagicRandom random(SEEDS[squareY(square)]);
+            for (int i = 0; i < size; ) {
+                for (magic.magic = 0; popCount((magic.magic * magic.mask) >> 56) < 6; )
+                    magic.magic = random.sparse();
+
+                // epoch marks which table entries were written by the current attempt
+                for (++attempt, i = 0; i < size; ++i) {
+                    const unsigned index = magic.index(occupancies[i]);
+                    if (epoch[index] < attempt) {
+                        epoch[index] = attempt;
+                        table[index] = references[i];
+                    }
+                    else if (table[index] != references[i])
+                        break;
+                }
+            }
+            table += size;
+        }
+    }
+
+    struct RookMagicsInitializer {
+        RookMagicsInitializer()
+        {
+            initRookMagics();
+            detail::rookBackend = PEXT_SUPPORTED ? RookBackend::Pext : RookBackend::Magic;
+        }
+    } rookMagicsInitializer;
+}
+
+bool config::isPextSupported()
+{
+    return PEXT_SUPPORTED;
+}
+
+config::RookBackend config::getRookBackend()
+{
+    return detail::rookBackend;
+}
+
+void config::setRookBackend(RookBackend backend)
+{
+    if (backend == RookBackend::Pext && !PEXT_SUPPORTED)
+        throw std::invalid_argument("BMI2 n'est pas disponible sur ce processeur");
+    detail::rookBackend = backend;
+}
+
+#if defined(CHESSCORE_X86_64) && !defined(_MSC_VER)
+__attribute__((target("bmi2")))
+#endif
+config::Bitboard config::rookAttacksPext(Square square, Bitboard occupancy)
+{
+#if defined(CHESSCORE_X86_64)
+    return rookPextAttacks[square][_pext_u64(occupancy, detail::rookMagics[square].mask)];
+#else
+    return rookAttacksMagic(square, occupancy);
+#endif
+}
+
+config::Bitboard config::slidingRookAttacks(Square square, Bitboard occupancy)
+{
+    static const int DIRECTIONS[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+    Bitboard attacks = EMPTY_BITBOARD;
+
+    for (const auto& direction : DIRECTIONS) {
+        int x = squareX(square) + direction[0];
+        int y = squareY(square) + direction[1];
+        while (x >= 0 && x < 8 && y >= 0 && y < 8) {
+            const Bitboard target = squareBit(makeSquare(x, y));
+            attacks |= target;
+            if (occupancy & target)
+                break;
+            x += direction[0];
+            y += direction[1];
+        }
+    }
+    return attacks;
+}
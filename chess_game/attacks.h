@@ -0,0 +1,126 @@
+#pragma once
+#include <array>
+#include "bitboard.h"
+
+namespace config {
+    namespace detail {
+        struct Offset {
+            int x;
+            int y;
+        };
+
+        template <std::size_t N>
+        constexpr std::array<Bitboard, 64> makeStepAttacks(const Offset (&offsets)[N])
+        {
+            std::array<Bitboard, 64> attacks{};
+
+            for (Square square = 0; square < 64; ++square) {
+                for (const Offset& offset : offsets) {
+                    const int x = squareX(square) + offset.x;
+                    const int y = squareY(square) + offset.y;
+                    if (x >= 0 && x < 8 && y >= 0 && y < 8)
+                        attacks[square] |= squareBit(makeSquare(x, y));
+                }
+            }
+            return attacks;
+        }
+
+        constexpr Offset KING_OFFSETS[] = {
+            {1, 0}, {-1, 0}, {1, 1}, {1, -1},
+            {-1, 1}, {-1, -1}, {0, 1}, {0, -1} };
+
+        constexpr Offset KNIGHT_OFFSETS[] = {
+            {+2, +1}, {+2, -1}, {-2, +1}, {-2, -1},
+            {+1, +2}, {+1, -2}, {-1, +2}, {-1, -2} };
+
+        constexpr std::array<std::array<Bitboard, 64>, 64> makeBetween()
+        {
+            std::array<std::array<Bitboard, 64>, 64> between{};
+
+            for (Square from = 0; from < 64; ++from) {
+                for (Square to = 0; to < 64; ++to) {
+                    if (from == to || (squareX(from) != squareX(to) && squareY(from) != squareY(to)))
+                        continue;
+
+                    const int stepX = (squareX(to) > squareX(from)) - (squareX(to) < squareX(from));
+                    const int stepY = (squareY(to) > squareY(from)) - (squareY(to) < squareY(from));
+                    for (int x = squareX(from) + stepX, y = squareY(from) + stepY; makeSquare(x, y) != to; x += stepX, y += stepY)
+                        between[from][to] |= squareBit(makeSquare(x, y));
+                }
+            }
+            return between;
+        }
+    }
+
+    // Squares reached from each square, generated at compile time.
+    constexpr std::array<Bitboard, 64> KING_ATTACKS = detail::makeStepAttacks(detail::KING_OFFSETS);
+    constexpr std::array<Bitboard, 64> KNIGHT_ATTACKS = detail::makeStepAttacks(detail::KNIGHT_OFFSETS);
+
+    // Squares strictly between two squares of the same rank or file, empty otherwise.
+    constexpr std::array<std::array<Bitboard, 64>, 64> BETWEEN = detail::makeBetween();
+
+    inline Bitboard betweenSquares(Square from, Square to)
+    {
+        return BETWEEN[from][to];
+    }
+
+    inline Bitboard kingAttacks(Square square)
+    {
+        return KING_ATTACKS[square];
+    }
+
+    inline Bitboard knightAttacks(Square square)
+    {
+        return KNIGHT_ATTACKS[square];
+    }
+
+    // Rank and file of the square, without the square : where a rook could see it from on an empty board.
+    constexpr Bitboard rookLines(Square square)
+    {
+        return ((Bitboard(0xFF) << (8 * squareY(square))) ^ (Bitboard(0x0101010101010101) << squareX(square)));
+    }
+
+    // Multiply-shift indexing into the rook attack table of one square.
+    struct Magic {
+        Bitboard mask;
+        Bitboard magic;
+        const Bitboard* attacks;
+        unsigned shift;
+
+        unsigned index(Bitboard occupancy) const
+        {
+            return static_cast<unsigned>(((occupancy & mask) * magic) >> shift);
+        }
+    };
+
+    // Magic works everywhere, Pext needs a CPU with BMI2.
+    enum class RookBackend { Magic, Pext };
+
+    namespace detail {
+        // Filled once at startup by attacks.cpp.
+        extern Magic rookMagics[64];
+        extern RookBackend rookBackend;
+    }
+
+    bool isPextSupported();
+    RookBackend getRookBackend();
+    void setRookBackend(RookBackend);
+
+    // Walks the four rays square by square, stopping on the first occupied square.
+    Bitboard slidingRookAttacks(Square, Bitboard occupancy);
+    Bitboard rookAttacksPext(Square, Bitboard occupancy);
+
+    inline Bitboard rookAttacksMagic(Square square, Bitboard occupancy)
+    {
+        const Magic& magic = detail::rookMagics[square];
+        return magic.attacks[magic.index(occupancy)];
+    }
+
+    // Uses the backend selected at startup from CPUID.
+    inline Bitboard rookAttacks(Square square, Bitboard occupancy)
+    {
+        if (detail::rookBackend == RookBackend::Pext)
+            return rookAttacksPext(square, occupancy);
+        return rookAttacksMagic(square, occupancy);
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace config {
+    // One bit per tile. Square indices follow the tile names of the board:
+    // index 0 is A8, index 63 is H1, and a tile (x, y) has the index 8 * y + x.
+    using Bitboard = std::uint64_t;
+    using Square = int;
+
+    constexpr Bitboard EMPTY_BITBOARD = 0;
+    constexpr Square NO_SQUARE = -1;
+
+    constexpr Square makeSquare(int x, int y)
+    {
+        return 8 * y + x;
+    }
+
+    constexpr int squareX(Square square)
+    {
+        return square & 7;
+    }
+
+    constexpr int squareY(Square square)
+    {
+        return square >> 3;
+    }
+
+    constexpr Bitboard squareBit(Square square)
+    {
+        return Bitboard(1) << square;
+    }
+
+    inline int popCount(Bitboard bitboard)
+    {
+#if defined(_MSC_VER)
+        return static_cast<int>(__popcnt64(bitboard));
+#else
+        return __builtin_popcountll(bitboard);
+#endif
+    }
+
+    // The bitboard must not be empty.
+    inline Square lowestSquare(Bitboard bitboard)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, bitboard);
+        return static_cast<Square>(index);
+#else
+        return __builtin_ctzll(bitboard);
+#endif
+    }
+
+    inline Square popLowestSquare(Bitboard& bitboard)
+    {
+        Square square = lowestSquare(bitboard);
+        bitboard &= bitboard - 1;
+        return square;
+    }
+}
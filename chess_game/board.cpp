@@ -1,19 +1,53 @@
 #include "structure.h"
-#include <QMessageBox>
-#include <QString>
-#include <QPoint>
-#include "utils.h"
+#include "tbprobe.h"
+#include <algorithm>
 #include <memory>
 
-config::Board::Board(const Color& color): turn_(color){}
+namespace {
+    using namespace config;
 
-std::unique_ptr<config::Tile> config::Board::createTile(const std::string& name, bool occupied) const
+    // Pieces hold no board state, so every board shares one instance per color and type.
+    const Piece* getSharedPiece(Color color, PieceType type)
+    {
+        static const std::unique_ptr<Piece> pieces[NUMBER_OF_COLORS][NUMBER_OF_PIECE_TYPES] = {
+            { Board::createPiece(BLACK_KING), Board::createPiece(BLACK_ROOK), Board::createPiece(BLACK_KNIGHT) },
+            { Board::createPiece(WHITE_KING), Board::createPiece(WHITE_ROOK), Board::createPiece(WHITE_KNIGHT) } };
+        return pieces[toIndex(color)][toIndex(type)].get();
+    }
+}
+
+config::Board::Board(const Color& color)
+{
+    position_.setSideToMove(color);
+    bindTiles();
+}
+
+config::Board::Board(const Board& other) :
+    position_(other.position_),
+    validMoves_(other.validMoves_),
+    nKings_(other.nKings_),
+    tablebases_(other.tablebases_)
 {
-    return std::make_unique<Tile>(name, occupied);
+    bindTiles();
 }
 
+config::Board& config::Board::operator=(const Board& other)
+{
+    // Tiles keep pointing at this board.
+    position_ = other.position_;
+    validMoves_ = other.validMoves_;
+    nKings_ = other.nKings_;
+    tablebases_ = other.tablebases_;
+    return *this;
+}
+
+void config::Board::bindTiles()
+{
+    for (Square square = 0; square < NUMBER_OF_TILES; ++square)
+        tiles_[square] = Tile(this, square);
+}
 
-std::unique_ptr<config::Piece> config::Board::createPiece(char charc) const
+std::unique_ptr<config::Piece> config::Board::createPiece(char charc)
 {
     using namespace std;
 
@@ -29,14 +63,12 @@ std::unique_ptr<config::Piece> config::Board::createPiece(char charc) const
     else if (charc == WHITE_ROOK)
         return make_unique<Rook>(Color::White);
 
-    else if (charc == WHITE_KING) {
-        ++nKings_;
+    else if (charc == WHITE_KING)
         return make_unique<King>(Color::White);
-    }
-    else if (charc == BLACK_KING) {
-        ++nKings_;
+
+    else if (charc == BLACK_KING)
         return make_unique<King>(Color::Black);
-    }
+
     return nullptr;
 }
 
@@ -45,36 +77,26 @@ void config::Board::resetNumberOfKings()
     nKings_ = 0;
 }
 
-
 void config::Board::reset() {
-    for (auto& row : board_) {
-        for (auto& tile : row) {
-            if (tile) {
-                tile->destroyOccupyingPiece();
-            }
-        }
-    }
-    turn_=Color::White;
-    check_ = false;
+    position_.clear();
     resetNumberOfKings();
 
 }
 
 void config::Board::create(const std::vector<std::pair<int, int>>& positions, const std::vector<char>& pieces)
 {
-    using namespace iter;
-
-    for (int x = 0; x < BOARD_DIMENSION_Y; ++x) {
-        for (int y = 0; y < BOARD_DIMENSION_X; ++y) {
-            board_[x][y] = createTile(tileNames_[BOARD_DIMENSION_X * y + x], false);
-        }
-    }
-
-    for (int i = 0; i < positions.size(); ++i) {
+    for (std::size_t i = 0; i < positions.size(); ++i) {
         int x = positions[i].first;
         int y = positions[i].second;
 
-        board_[x][y]->setOccupyingPiece(createPiece(pieces[i]));
+        Color color;
+        PieceType type;
+        if (!parsePieceName(pieces[i], color, type))
+            continue;
+
+        position_.addPiece(color, type, makeSquare(x, y));
+        if (type == PieceType::King)
+            ++nKings_;
 
         if (nKings_ > MAXIMUM_KINGS_CONFRONTATION)
             throw CorrectNumberofKings(KING_OVER_LIMIT);
@@ -86,341 +108,121 @@ void config::Board::create(const std::vector<std::pair<int, int>>& positions, co
 
 std::pair<config::Tile*, std::pair<int, int>> config::Board::findTile(const char pieceName) const
 {
-    using namespace iter;
-
-    for (int x : range(BOARD_DIMENSION_Y))
-        for (int y : range(BOARD_DIMENSION_X))
-            if (board_[x][y]->getIsOccupied() && board_[x][y]->getOccupyingPiece()->getName() ==pieceName)
-                    return { board_[x][y].get(), { x, y } };
-
-    return { nullptr, { 0,0 } };
-}
-
+    Color color;
+    PieceType type;
+    if (!parsePieceName(pieceName, color, type))
+        return { nullptr, { 0,0 } };
 
+    const Bitboard pieces = position_.getPieces(color, type);
+    if (!pieces)
+        return { nullptr, { 0,0 } };
 
-void config::Board::calculatePossibleMoves(Piece* piece, const std::pair<int, int>& initialPosition)
-{
-    piece->calculatePossibleSimpleMovements(initialPosition, this);
+    const Square square = type == PieceType::King ? position_.getKingSquare(color) : lowestSquare(pieces);
+    return { &tiles_[square], { squareX(square), squareY(square) } };
 }
 
 void config::Board::resetValidPiecePositions()
 {
-    using namespace iter;
-
-    for (int y : range(BOARD_DIMENSION_Y))
-        for (int x : range(BOARD_DIMENSION_X))
-            if (board_[y][x]->getIsOccupied())
-                if (board_[y][x]->getOccupyingPiece()->getColor() == turn_)
-                    calculatePossibleMoves(board_[y][x]->getOccupyingPiece(), { y, x });
+    validMoves_.clear();
+    generateLegal(position_, validMoves_);
 }
 
-void config::Board::invertTurn()
+const config::MoveList& config::Board::getValidMoves() const
 {
-    if (turn_ == Color::White)
-        turn_ = Color::Black;
-    else
-        turn_ = Color::White;
+    return validMoves_;
 }
 
-
 void config::Board::setTurn(const config::Color& Color)
 {
-    turn_ = Color;
+    position_.setSideToMove(Color);
 }
 
-
 config::Color config::Board::getTurn() const
 {
-    return turn_;
+    return position_.getSideToMove();
 }
 
-
-
-std::pair<int, int> config::Board::getTilePosition(Tile* tile) const
+bool config::Board::getCheckState() const
 {
-    using namespace iter;
-
-    for (int x : range(BOARD_DIMENSION_Y))
-        for (int y : range(BOARD_DIMENSION_X))
-            if (board_[x][y].get() == tile)
-                return { x,y };
-
-    return { 0, 0 };
+    return position_.getCheckState();
 }
 
-
-
-bool config::Board::testCheckAfterMove(Tile* finalTile)
+void config::Board::movePiece(Tile* initialTile, Tile* finalTile)
 {
-    using namespace std;
-
-    finalTile->getOccupyingPiece()->calculatePossibleSimpleMovements(getTilePosition(finalTile), this);
-
-    const vector<pair<int, int>> MOUVEMENTS_POSSIBLES = finalTile->getOccupyingPiece()->getPossibleMovements();
-    char KingChar = (getTurn() == Color::White) ? BLACK_KING : WHITE_KING;
-    const std::pair<Tile*, std::pair<int, int>> king = findTile(KingChar);
-    auto enemyKing = king.second;
-
-    for (auto mouvement : MOUVEMENTS_POSSIBLES) {
-        if (enemyKing == mouvement) {
-            return true;
-        }
-    }
-
-    return false;
+    position_.makeMove(Move(initialTile->getSquare(), finalTile->getSquare()));
+    // a played move is never taken back
+    position_.clearHistory();
 }
 
-bool config::Board::testCheckAfterOpponentMove(Tile* finalTile)
+config::Tile* config::Board::getTile(const std::pair<int, int>& position) const
 {
-    using namespace std;
-
-    invertTurn();
-    finalTile->getOccupyingPiece()->calculatePossibleBasicMovements(getTilePosition(finalTile), this);
-     
-    const vector<pair<int, int>> MOUVEMENTS_POSSIBLES = finalTile->getOccupyingPiece()->getPossibleMovements();
-
-    for (auto mouvement : MOUVEMENTS_POSSIBLES)
-        if (getTile(mouvement)->getIsOccupied() && 
-            getTile(mouvement)->getOccupyingPiece()->getName() == (Color::Black == turn_ ? WHITE_KING : BLACK_KING)) 
-        {
-            invertTurn();
-            return true;
-        }
-    invertTurn();
-    return false;
+    return &tiles_[makeSquare(position.first, position.second)];
 }
 
-
-void config::Board::invertCheck()
+config::Tile* config::Board::getTile(Square square) const
 {
-        check_ = !check_;
-}
-
-void config::Board::setIsCheck() {
-    check_ = true;
+    return &tiles_[square];
 }
 
-bool config::Board::getCheckState() const
+const config::Piece* config::Board::getPieceAt(Square square) const
 {
-    return check_;
-}
-
+    Color color;
+    PieceType type;
+    if (!position_.getPieceAt(square, color, type))
+        return nullptr;
 
-
-void config::Board::movePiece(Tile* initialTile, Tile* finalTile)
-{
-    if (finalTile->getIsOccupied())
-        finalTile->destroyOccupyingPiece();
-
-    finalTile->setOccupyingPiece(initialTile->changePossessingPiece());
-    initialTile->destroyOccupyingPiece();
-    finalTile->getOccupyingPiece()->setColor(turn_);
-    if (testCheckAfterMove(finalTile)) {
-        check_ = true;
-    }
-    else {
-        check_ = false;
-    }
-    invertTurn();
+    return getSharedPiece(color, type);
 }
 
-config::Tile* config::Board::getTile(const std::pair<int, int>& position) const
+const config::Position& config::Board::getPosition() const
 {
-    return board_[position.first][position.second].get();
+    return position_;
 }
 
-
-bool config::Board::testCheckProtection(const std::pair<int, int>& initialPosition, const std::pair<int, int>& mouvement)
+config::Key config::Board::hash() const
 {
-    using namespace iter;
-    //if (!check_) {
-    //    Debug::show("testCheckProtection was called while not in check.");
-    //    return false;
-    //}
-
-    Tile* posTile = getTile(mouvement);
-    Tile* initialTile = getTile(initialPosition);
-
-
-    if (!initialTile || !initialTile->getIsOccupied()) {
-        return false;
-    }
-
-    initialTile->getOccupyingPiece()->calculatePossibleBasicMovements(initialPosition, this);
-    const auto& validMoves = initialTile->getOccupyingPiece()->getPossibleMovements();
-    auto canMove = std::find(validMoves.begin(), validMoves.end(), mouvement);
-    if (canMove == validMoves.end()) {
-        return false;
-    }
-
-    bool originalCheck = check_;
-
-    std::unique_ptr <config::Piece> savedPiece = nullptr;
-    if (posTile->getIsOccupied()) {
-        if (posTile->getOccupyingPiece()->getColor() == turn_)
-            return false;
-        savedPiece = posTile->changePossessingPiece();
-    }
-
-    posTile->setOccupyingPiece(initialTile->changePossessingPiece());
-    initialTile->reverseOccupation();
-
-    char KingChar = (getTurn() == config::Color::White) ? WHITE_KING : BLACK_KING;
-    const std::pair<Tile*, std::pair<int, int>> king = findTile(KingChar);
-
-    if (!king.first) {
-        initialTile->setOccupyingPiece(posTile->changePossessingPiece());
-        posTile->reverseOccupation();
-        if (savedPiece) posTile->setOccupyingPiece(std::move(savedPiece));
-        return false;
-    }
-     
-    invertTurn();
-    invertCheck();
-
-    for (int x : range(BOARD_DIMENSION_Y)) {
-        for (int y : range(BOARD_DIMENSION_X))
-            if (board_[x][y]->getIsOccupied() &&
-                board_[x][y]->getOccupyingPiece()->getColor() == turn_)
-            {
-                if (testCheckAfterMove(board_[x][y].get())) {
-                    initialTile->setOccupyingPiece(posTile->changePossessingPiece());
-                    posTile->reverseOccupation();
-                    if (savedPiece) {
-                        posTile->setOccupyingPiece(std::move(savedPiece));
-                    }
-                    invertCheck();
-                    invertTurn();
-                    return false;
-                }
-            }
-    }
-    initialTile->setOccupyingPiece(posTile->changePossessingPiece());
-    posTile->reverseOccupation();
-    if (savedPiece){
-        posTile->setOccupyingPiece(std::move(savedPiece));
-    }
-    
-    //check_ = originalCheck;
-    invertTurn();
-    return true;
+    return position_.hash();
 }
 
-bool config::Board::testUnprotectedCheck(const std::pair<int, int>& initialPosition, const std::pair<int, int>& mouvement)
+std::string config::Board::getTileName(Square square) const
 {
-    using namespace std;
-    using namespace iter;
-
-    Tile* initialTile = getTile(initialPosition);
-    Tile* posTile = getTile(mouvement);
-    bool				check = false;
-    bool				attackingPiece = false;
-    unique_ptr<Piece>	attackingPieceTemp;
-
-    if (posTile->getIsOccupied()) {
-        attackingPieceTemp = posTile->changePossessingPiece();
-        attackingPiece = true;
-    }
-
-    posTile->setOccupyingPiece(initialTile->changePossessingPiece());
-    initialTile->reverseOccupation();
-
-    char enemyKingChar = (turn_ == Color::White) ? BLACK_KING : WHITE_KING;
-
-    for (int y : range(BOARD_DIMENSION_Y)) {
-        for (int x : range(BOARD_DIMENSION_X)) {
-            if (board_[y][x]->getIsOccupied() && board_[y][x]->getOccupyingPiece()->getColor() != turn_ && board_[y][x]->getOccupyingPiece()->getName() != enemyKingChar) {
-                if (testCheckAfterOpponentMove(board_[y][x].get())) {
-                    check = true;
-                    break;
-                }
+    return TILE_NAMES[square];
+}
 
-            }
-        }
-        if (check) {
-            break;
-        }
-    }
+bool config::Board::isDraw() const {
+    return position_.isInsufficientMaterial();
+}
 
-    initialTile->setOccupyingPiece(posTile->changePossessingPiece());
-    posTile->reverseOccupation();
+config::GameState config::Board::getGameState() const {
+    // A table for the material settles it in one probe ; plain draws also cover insufficient material,
+    // which the prober answers without a table, so they still need the move test.
+    const TablebaseValue value = probeTablebase();
+    if (value == TB_MATED)
+        return GameState::Checkmate;
+    if (value == TB_STALEMATE)
+        return GameState::Stalemate;
 
-    if (attackingPiece)
-        posTile->setOccupyingPiece(std::move(attackingPieceTemp));
+    if ((value == TB_UNKNOWN || value == TB_DRAW) && !hasLegalMove(position_))
+        return position_.isInCheck(getTurn()) ? GameState::Checkmate : GameState::Stalemate;
 
-    return check;
+    if (isDraw())
+        return GameState::InsufficientMaterial;
+    return GameState::Ongoing;
 }
 
-bool config::Board::isDraw() const {
-    int whiteKing = 0, blackKing = 0;
-    int whiteKnights = 0, blackKnights = 0;
-    int otherPieces = 0;
-
-    for (int x = 0; x < BOARD_DIMENSION_X; ++x) {
-        for (int y = 0; y < BOARD_DIMENSION_Y; ++y) {
-            const auto& tile = board_[x][y];
-            if (tile->getIsOccupied()) {
-                char name = tile->getOccupyingPiece()->getName();
-                switch (name) {
-                case WHITE_KING: whiteKing++; break;
-                case BLACK_KING: blackKing++; break;
-                case WHITE_KNIGHT: whiteKnights++; break;
-                case BLACK_KNIGHT: blackKnights++; break;
-                default: otherPieces++;
-                }
-            }
-        }
-    }
-
-    // Two kings and no other piece
-    if (whiteKing == 1 && blackKing == 1 && whiteKnights == 0 && blackKnights == 0 && otherPieces == 0)
-        return true;
-
-    // Two kings and exactly one knight
-    if (whiteKing == 1 && blackKing == 1 && otherPieces == 0) {
-        if ((whiteKnights == 1 && blackKnights == 0) || (whiteKnights == 0 && blackKnights == 1))
-            return true;
-    }
+bool config::Board::isCheckmate() const {
+    return getGameState() == GameState::Checkmate;
+}
 
-    return false;
+bool config::Board::isStalemate() const {
+    return getGameState() == GameState::Stalemate;
 }
 
-bool config::Board::isCheckmate(){
-    using namespace iter;
-    if (!check_)
-        return false;  
-
-    char kingChar = (turn_ == Color::White) ? WHITE_KING : BLACK_KING;
-    auto [kingTile, kingPos] = findTile(kingChar);
-    if (!kingTile) return false; 
-
-    Piece* kingPiece = kingTile->getOccupyingPiece();
-    kingPiece->calculatePossibleSimpleMovements(kingPos, this);
-    const auto& kingMoves = kingPiece->getPossibleMovements();
-    if (!kingMoves.empty())
-        return false;  
-
-    //for (int y : range(BOARD_DIMENSION_Y)) {
-    //    for (int x : range(BOARD_DIMENSION_X)) {
-    //        Tile* tile = board_[y][x].get();
-    //        if (!tile->getIsOccupied()) 
-    //            continue;
-    //        Piece* piece = tile->getOccupyingPiece();
-    //        if (piece->getColor() != turn_) 
-    //            continue;
-    //        if (piece->getName() == kingChar) 
-    //            continue; 
-    //        piece->calculatePossibleSimpleMovements({ y, x }, this);
-    //        const auto& pMoves = piece->getPossibleMovements();
-    //        for (const auto& to : pMoves) {
-
-    //            if (testCheckProtection({ y, x }, to)) {
-    //                return false; 
-    //            }
-    //        }
-    //    }
-    //}
-    return true;
+void config::Board::setTablebases(const TablebaseProber* tablebases) {
+    tablebases_ = tablebases;
 }
 
+config::TablebaseValue config::Board::probeTablebase() const {
+    return tablebases_ ? tablebases_->probe(position_) : TB_UNKNOWN;
+}
 
@@ -1,6 +1,7 @@
 ﻿#include "chesswindow.h"
 #include "ui_chesswindow.h"
 #include "structure.h"
+#include "scenarios.h"
 #include <QGraphicsScene>
 #include <QGraphicsRectItem>
 #include <QGraphicsPixmapItem>
@@ -36,6 +37,18 @@ ChessWindow::ChessWindow(QWidget *parent)
 
     createScenarios();
 
+    // Endgame tables found next to the game settle mates, stalemates and won or drawn positions in one probe.
+    try {
+        std::vector<std::string> errors;
+        tablebases.addDirectory("tablebases", &errors);
+        for (const std::string& error : errors)
+            Debug::show(error.c_str());
+    }
+    catch (const std::exception& error) {
+        Debug::show(error.what());
+    }
+    board.setTablebases(&tablebases);
+
     connect(this, &ChessWindow::clicked, this, &ChessWindow::PieceMoved);
     connect(ui->scenarioSelector, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ChessWindow::scenarioSelector);
 }
@@ -46,20 +59,18 @@ ChessWindow::~ChessWindow()
 }
 
 void ChessWindow::createScenarios() {
-    possiblescenarios = {
-        { { {1, 3}, {6, 6}, {0, 5}, {7, 0}, {3, 4}, {4, 4} }, {config::WHITE_ROOK, config::WHITE_ROOK, config::WHITE_KING,config::BLACK_ROOK, config::BLACK_ROOK,config::BLACK_KING} },
-        { { {1, 5}, {6, 6}, {4, 6}, {4, 0}, {2, 3}, {1, 2} }, {config::WHITE_KNIGHT, config::WHITE_KNIGHT, config::WHITE_KING, config::BLACK_KNIGHT, config::BLACK_KNIGHT,config::BLACK_KING} },
-        { { {4, 4}, {6, 7}, {4, 7}, {1, 5}, {0, 3}, {2, 0} }, {config::WHITE_KNIGHT, config::WHITE_ROOK, config::WHITE_KING,config::BLACK_KNIGHT,config::BLACK_KNIGHT,config::BLACK_KING} },
-        { { {1, 7}, {4, 7}, {2, 6}, {5, 4}, {3, 3}, {2, 0} }, {config::WHITE_KNIGHT, config::WHITE_ROOK, config::WHITE_KING,config::BLACK_ROOK,config::BLACK_ROOK,config::BLACK_KING} },
-        { { {3, 7}, {2, 5}, {5, 7}, {7, 4}, {0, 7}, {1, 2} }, {config::WHITE_KNIGHT, config::WHITE_ROOK, config::WHITE_KING,config::BLACK_KNIGHT,config::BLACK_ROOK,config::BLACK_KING} },
-    };
     ui->scenarioSelector->addItem("🧩 Chosir scenario");
-    ui->scenarioSelector->addItem("2 tours vs 2 tours");
-    ui->scenarioSelector->addItem("2 cavaliers vs 2 cavaliers");
-    ui->scenarioSelector->addItem("1 cavalier-1 tour vs 2 cavaliers");
-    ui->scenarioSelector->addItem("1 cavalier-1 tour vs 2 tours");
-    ui->scenarioSelector->addItem("1 cavalier-1 tour vs 1 cavalier-1 tour");
 
+    for (const config::Scenario& scenario : config::getScenarios()) {
+        Scenario possiblescenario;
+        for (const auto& position : scenario.positions)
+            possiblescenario.position.push_back(QPoint(position.first, position.second));
+        for (char piece : scenario.pieces)
+            possiblescenario.piece.push_back(QChar(piece));
+
+        possiblescenarios.push_back(possiblescenario);
+        ui->scenarioSelector->addItem(QString::fromUtf8(scenario.name));
+    }
 }
 
 
@@ -108,6 +119,7 @@ void ChessWindow::setScenario(const ChessWindow::Scenario& scenario) {
     SecondClickOn = false;
     gameOn = true;
     startingSide();
+    showTablebaseVerdict();
 
 
 }
@@ -181,17 +193,12 @@ void ChessWindow::PieceMoved(const QPoint& from, const QPoint& to) {
     pieceGraphics[to] = item;
 
     resetTileColors();
-
-    if (board.isDraw()) {
-        gameOn = false;
-        auto msg = QString("Partie nulle !");
-        DrawDialog("matériel insuffisant", msg);
-
-    }
 }
 
 void ChessWindow::movePiece(const QPoint& from, const QPoint& to) {
-    auto tile = board.getTile({ from.x(), from.y() });
+    const config::Square fromSquare = config::makeSquare(from.x(), from.y());
+    const config::Square toSquare = config::makeSquare(to.x(), to.y());
+    auto tile = board.getTile(fromSquare);
     if (!tile->getIsOccupied()) {
         return;
     }
@@ -200,21 +207,15 @@ void ChessWindow::movePiece(const QPoint& from, const QPoint& to) {
         return;
     }
     auto piece = tile->getOccupyingPiece();
-    piece->calculatePossibleSimpleMovements({ from.x(), from.y() }, &board);
-    auto validMoves = piece->getPossibleMovements();
-    auto canMove = std::find(validMoves.begin(), validMoves.end(), std::make_pair(to.x(), to.y()));
-
-    if (board.getCheckState() && !board.testCheckProtection({ from.x(), from.y() }, { to.x(), to.y() })) {
-        if (board.isCheckmate()) {
-            gameOn = false;
-            QString msg = (board.getTurn() == config::Color::White)
-                ? "Victoire des noirs !"  
-                : "Victoire des blancs !";
-            DrawDialog("Échec et mat !",msg);
+    config::MoveList validMoves;
+    piece->calculatePossibleSimpleMovements(fromSquare, &board, validMoves);
+    bool canMove = validMoves.contains(fromSquare, toSquare);
+
+    if (board.getCheckState() && !canMove) {
+        if (showGameOver())
             return;
-        }
         for (const auto& move : validMoves) {
-            QGraphicsRectItem* tile = tileRects[move.second][move.first];
+            QGraphicsRectItem* tile = tileRects[config::squareY(move.getTo())][config::squareX(move.getTo())];
             tile->setBrush(QColor(0, 255, 0, 127));  // semi-transparent green
             tile->setZValue(-1);
         }
@@ -222,18 +223,12 @@ void ChessWindow::movePiece(const QPoint& from, const QPoint& to) {
         return;
     }
 
-    if (canMove != validMoves.end()) {
-        board.movePiece(tile, board.getTile({ to.x(), to.y() }));
+    if (canMove) {
+        board.movePiece(tile, board.getTile(toSquare));
         emit clicked(from, to);
+        if (showGameOver())
+            return;
         if (board.getCheckState()) {
-            if (board.isCheckmate()) {
-                gameOn = false;
-                QString msg = (board.getTurn() == config::Color::White)
-                    ? "Victoire de noir !"
-                    : "Victoire de blanc !";
-                DrawDialog("Échec et mat !", msg);
-                return;
-            }
             char KingChar = (board.getTurn() == config::Color::White) ? config::WHITE_KING : config::BLACK_KING;
             const auto king = board.findTile(KingChar);
             if (king.first) {
@@ -243,13 +238,14 @@ void ChessWindow::movePiece(const QPoint& from, const QPoint& to) {
             }
         }
         board.resetValidPiecePositions();
+        showTablebaseVerdict();
     }
     else{
         Debug::show(board.getCheckState()
             ? "Vous devez parer l’échec"
             : "Vous ne pouvez pas vous déplacer ici");
         for (const auto& move : validMoves) {
-            QGraphicsRectItem* tile = tileRects[move.second][move.first];  
+            QGraphicsRectItem* tile = tileRects[config::squareY(move.getTo())][config::squareX(move.getTo())];  
             tile->setBrush(QColor(0, 255, 0, 127));  // semi-transparent green
             tile->setZValue(-1);  
         }
@@ -257,6 +253,49 @@ void ChessWindow::movePiece(const QPoint& from, const QPoint& to) {
 
 }
 
+// Ends the game with its dialog once the side to move is mated, stalemated or short of mating material.
+bool ChessWindow::showGameOver() {
+    switch (board.getGameState()) {
+    case config::GameState::Checkmate: {
+        gameOn = false;
+        QString msg = (board.getTurn() == config::Color::White)
+            ? "Victoire des noirs !"
+            : "Victoire des blancs !";
+        DrawDialog("Échec et mat !", msg);
+        return true;
+    }
+    case config::GameState::Stalemate:
+        gameOn = false;
+        DrawDialog("pat", "Partie nulle !");
+        return true;
+    case config::GameState::InsufficientMaterial:
+        gameOn = false;
+        DrawDialog("matériel insuffisant", "Partie nulle !");
+        return true;
+    case config::GameState::Ongoing:
+        break;
+    }
+    return false;
+}
+
+// Outcome with best play from the endgame table of the current material, in the status bar.
+void ChessWindow::showTablebaseVerdict() {
+    const config::TablebaseValue value = board.probeTablebase();
+    if (value == config::TB_UNKNOWN) {
+        ui->statusbar->clearMessage();
+        return;
+    }
+    if (!config::isMateValue(value)) {
+        ui->statusbar->showMessage("Table de finales : nulle avec un jeu parfait");
+        return;
+    }
+
+    const bool sideToMoveWins = config::getWDL(value) == config::WDL::Win;
+    const bool whiteWins = sideToMoveWins == (board.getTurn() == config::Color::White);
+    const int moves = (config::getPliesToMate(value) + 1) / 2;
+    ui->statusbar->showMessage(QString("Table de finales : %1 matent en %2 coups").arg(whiteWins ? "les blancs" : "les noirs").arg(moves));
+}
+
 void ChessWindow::mousePressEvent(QMouseEvent* event) 
 {
     resetTileColors();
@@ -4,8 +4,9 @@
 #include <QMainWindow>
 #include <QGraphicsScene>
 #include "structure.h"
+#include "tbprobe.h"
 #include <vector>
-#include <Qhash>
+#include <QHash>
 #include <QMouseEvent>
 
 QT_BEGIN_NAMESPACE
@@ -29,6 +30,7 @@ private:
     Ui::ChessWindow* ui;
     bool gameOn = true;
     config::Board board;
+    config::TablebaseProber tablebases;
     const int tileSize = 60;
     QGraphicsScene* scene;
     QGraphicsRectItem* tileRects[config::BOARD_DIMENSION_Y][config::BOARD_DIMENSION_X];
@@ -52,6 +54,8 @@ private:
     void DrawDialog(const QString& reason,QString res);
     void startingSide();
     void resetTileColors();
+    bool showGameOver();
+    void showTablebaseVerdict();
 
 };
 #endif // CHESSWINDOW_H
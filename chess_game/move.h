@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include "bitboard.h"
+
+namespace config {
+    enum class MoveFlag : std::uint16_t { Quiet = 0, Capture = 1 };
+
+    // 16-bit move : from (bits 0-5), to (bits 6-11), flags (bits 12-15).
+    // Trivially default-constructed, so that move lists are not filled on creation : use Move{} or NULL_MOVE for no move.
+    class Move {
+    public:
+        Move() = default;
+        constexpr Move(Square from, Square to, MoveFlag flag = MoveFlag::Quiet) :
+            data_(static_cast<std::uint16_t>(from | (to << 6) | (static_cast<std::uint16_t>(flag) << 12)))
+        {
+        }
+
+        constexpr Square getFrom() const { return data_ & 0x3F; }
+        constexpr Square getTo() const { return (data_ >> 6) & 0x3F; }
+        constexpr MoveFlag getFlag() const { return static_cast<MoveFlag>(data_ >> 12); }
+        constexpr bool isCapture() const { return getFlag() == MoveFlag::Capture; }
+        constexpr bool isNull() const { return data_ == 0; }
+        constexpr std::uint16_t getData() const { return data_; }
+        static constexpr Move fromData(std::uint16_t data)
+        {
+            Move move{};
+            move.data_ = data;
+            return move;
+        }
+
+        constexpr bool operator==(const Move& other) const { return data_ == other.data_; }
+        constexpr bool operator!=(const Move& other) const { return data_ != other.data_; }
+
+    private:
+        std::uint16_t data_;
+    };
+
+    static_assert(std::is_trivially_default_constructible<Move>::value, "MoveList relies on uninitialized moves");
+
+    constexpr Move NULL_MOVE{};
+    constexpr int MAX_MOVES = 256;
+
+//Fixed-capacity move list, meant to live on the stack
+    class MoveList {
+    public:
+        void add(const Move& move) { moves_[size_++] = move; }
+        void clear() { size_ = 0; }
+        int size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        const Move& operator[](int index) const { return moves_[index]; }
+        Move& operator[](int index) { return moves_[index]; }
+        const Move* begin() const { return moves_; }
+        const Move* end() const { return moves_ + size_; }
+        Move* begin() { return moves_; }
+        Move* end() { return moves_ + size_; }
+
+        bool contains(Square from, Square to) const
+        {
+            for (const Move& move : *this)
+                if (move.getFrom() == from && move.getTo() == to)
+                    return true;
+            return false;
+        }
+
+    private:
+        Move moves_[MAX_MOVES];
+        int size_ = 0;
+    };
+
+    // One move per target square, flagged as a capture when the target holds an enemy piece.
+    inline void addMoves(MoveList& moves, Square from, Bitboard targets, Bitboard enemies)
+    {
+        while (targets) {
+            const Square to = popLowestSquare(targets);
+            moves.add(Move(from, to, (enemies & squareBit(to)) ? MoveFlag::Capture : MoveFlag::Quiet));
+        }
+    }
+}
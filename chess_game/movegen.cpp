@@ -0,0 +1,185 @@
+#include "movegen.h"
+#include "attacks.h"
+
+namespace {
+    using namespace config;
+
+    void generateKingMoves(const Position& position, MoveList& moves, Bitboard from)
+    {
+        const Color us = position.getSideToMove();
+        const Square kingSquare = position.getKingSquare(us);
+        if (kingSquare == NO_SQUARE || !(squareBit(kingSquare) & from))
+            return;
+
+        const Bitboard targets = kingAttacks(kingSquare) & ~position.getPieces(us) & ~getKingDanger(position);
+        addMoves(moves, kingSquare, targets, position.getPieces(opposite(us)));
+    }
+
+    // A piece alone between its king and an enemy rook may only move along that ray : onPin is called with
+    // the square of each such piece of the side to move and its ray, up to the rook. Returns the pinned pieces.
+    template <typename OnPin>
+    Bitboard findPins(const Position& position, OnPin onPin)
+    {
+        const Color us = position.getSideToMove();
+        const Color them = opposite(us);
+        const Square kingSquare = position.getKingSquare(us);
+        if (kingSquare == NO_SQUARE)
+            return EMPTY_BITBOARD;
+
+        Bitboard pinned = EMPTY_BITBOARD;
+        Bitboard snipers = rookAttacks(kingSquare, position.getPieces(them)) & position.getPieces(them, PieceType::Rook);
+        while (snipers) {
+            const Square sniper = popLowestSquare(snipers);
+            const Bitboard blockers = betweenSquares(kingSquare, sniper) & position.getOccupancy();
+            if (popCount(blockers) != 1 || !(blockers & position.getPieces(us)))
+                continue;
+
+            pinned |= blockers;
+            onPin(lowestSquare(blockers), betweenSquares(kingSquare, sniper) | squareBit(sniper));
+        }
+        return pinned;
+    }
+
+    // Where the pieces other than the king may land : anywhere out of check, on the checker or between it
+    // and the king against a single check, nowhere against a double check.
+    Bitboard getEvasionTargets(const Position& position, Bitboard checkers)
+    {
+        if (!checkers)
+            return ~EMPTY_BITBOARD;
+        if (popCount(checkers) != 1)
+            return EMPTY_BITBOARD;
+        return checkers | betweenSquares(position.getKingSquare(position.getSideToMove()), lowestSquare(checkers));
+    }
+
+    // Knight and rook moves landing on `targets`.
+    void generatePieceMoves(const Position& position, MoveList& moves, Bitboard from, Bitboard targets)
+    {
+        const Color us = position.getSideToMove();
+        const Bitboard enemyPieces = position.getPieces(opposite(us));
+        const Bitboard occupancy = position.getOccupancy();
+        const Bitboard ownRooks = position.getPieces(us, PieceType::Rook);
+
+        targets &= ~position.getPieces(us);
+
+        const Bitboard pinned = findPins(position, [&](Square square, Bitboard ray) {
+            if (squareBit(square) & from & ownRooks)
+                addMoves(moves, square, rookAttacks(square, occupancy) & ray & targets, enemyPieces);
+        });
+
+        Bitboard knights = position.getPieces(us, PieceType::Knight) & from & ~pinned;
+        while (knights) {
+            const Square square = popLowestSquare(knights);
+            addMoves(moves, square, knightAttacks(square) & targets, enemyPieces);
+        }
+
+        Bitboard rooks = position.getPieces(us, PieceType::Rook) & from & ~pinned;
+        while (rooks) {
+            const Square square = popLowestSquare(rooks);
+            addMoves(moves, square, rookAttacks(square, occupancy) & targets, enemyPieces);
+        }
+    }
+}
+
+config::Bitboard config::getCheckers(const Position& position)
+{
+    const Color us = position.getSideToMove();
+    const Square king = position.getKingSquare(us);
+    if (king == NO_SQUARE)
+        return EMPTY_BITBOARD;
+
+    return position.getAttackers(king, opposite(us), position.getOccupancy());
+}
+
+config::Bitboard config::getKingDanger(const Position& position)
+{
+    return position.getAttackedSquares(opposite(position.getSideToMove()));
+}
+
+void config::generateLegal(const Position& position, MoveList& moves, Bitboard from)
+{
+    if (getCheckers(position)) {
+        generateEvasions(position, moves, from);
+        return;
+    }
+
+    generateKingMoves(position, moves, from);
+    generatePieceMoves(position, moves, from, ~EMPTY_BITBOARD);
+}
+
+void config::generateEvasions(const Position& position, MoveList& moves, Bitboard from)
+{
+    const Bitboard checkers = getCheckers(position);
+
+    generateKingMoves(position, moves, from);
+
+    // Capture the checker, or step between it and the king ; a knight check leaves no square between.
+    // Against a double check only the king can move.
+    const Bitboard targets = getEvasionTargets(position, checkers);
+    if (targets)
+        generatePieceMoves(position, moves, from, targets);
+}
+
+bool config::hasLegalMove(const Position& position)
+{
+    const Color us = position.getSideToMove();
+    const Square kingSquare = position.getKingSquare(us);
+    if (kingSquare != NO_SQUARE && (kingAttacks(kingSquare) & ~position.getPieces(us) & ~getKingDanger(position)))
+        return true;
+
+    const Bitboard targets = getEvasionTargets(position, getCheckers(position)) & ~position.getPieces(us);
+    if (!targets)
+        return false;
+
+    const Bitboard occupancy = position.getOccupancy();
+    const Bitboard ownRooks = position.getPieces(us, PieceType::Rook);
+    bool found = false;
+    const Bitboard pinned = findPins(position, [&](Square square, Bitboard ray) {
+        if (squareBit(square) & ownRooks)
+            found = found || (rookAttacks(square, occupancy) & ray & targets);
+    });
+    if (found)
+        return true;
+
+    Bitboard knights = position.getPieces(us, PieceType::Knight) & ~pinned;
+    while (knights)
+        if (knightAttacks(popLowestSquare(knights)) & targets)
+            return true;
+
+    Bitboard rooks = ownRooks & ~pinned;
+    while (rooks)
+        if (rookAttacks(popLowestSquare(rooks), occupancy) & targets)
+            return true;
+
+    return false;
+}
+
+void config::generateUnmoves(const Position& position, MoveList& moves)
+{
+    const Color moved = opposite(position.getSideToMove());
+    const Bitboard occupancy = position.getOccupancy();
+    const Square enemyKing = position.getKingSquare(opposite(moved));
+    const Bitboard kingContact = enemyKing != NO_SQUARE ? kingAttacks(enemyKing) : EMPTY_BITBOARD;
+
+    // King, knight and rook moves are symmetric : a piece came from any empty square it attacks now.
+    Bitboard pieces = position.getPieces(moved);
+    while (pieces) {
+        const Square square = popLowestSquare(pieces);
+        Color color;
+        PieceType type;
+        position.getPieceAt(square, color, type);
+
+        Bitboard origins;
+        switch (type) {
+        case PieceType::King:
+            origins = kingAttacks(square) & ~kingContact;
+            break;
+        case PieceType::Knight:
+            origins = knightAttacks(square);
+            break;
+        default:
+            origins = rookAttacks(square, occupancy);
+            break;
+        }
+        addMoves(moves, square, origins & ~occupancy, EMPTY_BITBOARD);
+    }
+}
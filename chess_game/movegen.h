@@ -0,0 +1,26 @@
+#pragma once
+#include "move.h"
+#include "position.h"
+
+namespace config {
+    // Enemy pieces attacking the king of the side to move.
+    Bitboard getCheckers(const Position&);
+
+    // Squares the king of the side to move may not step on : every square the enemy attacks,
+    // with the rook rays continuing past the king.
+    Bitboard getKingDanger(const Position&);
+
+    // Legal moves of the side to move, for the pieces standing on `from` only.
+    void generateLegal(const Position&, MoveList&, Bitboard from = ~EMPTY_BITBOARD);
+
+    // Legal moves when the side to move is in check : king escapes, captures of the checker and interpositions.
+    void generateEvasions(const Position&, MoveList&, Bitboard from = ~EMPTY_BITBOARD);
+
+    // Whether generateLegal would find a move, stopping at the first one : king steps first, then the other pieces.
+    bool hasLegalMove(const Position&);
+
+    // Non-capturing moves the side that just moved could have played to reach the position :
+    // each move goes from the piece's current square back to an empty square it came from.
+    // A king never comes from a square touching the enemy king ; any other legality check is left to the caller.
+    void generateUnmoves(const Position&, MoveList&);
+}
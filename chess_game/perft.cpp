@@ -0,0 +1,267 @@
+#include "perft.h"
+#include "movegen.h"
+#include "attacks.h"
+#include <initializer_list>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    using namespace config;
+
+    // The pieces alone, copied and moved by the reference generator instead of a Position.
+    struct ReferenceNode {
+        Bitboard pieces[NUMBER_OF_COLORS][NUMBER_OF_PIECE_TYPES];
+        int sideToMove;
+
+        Bitboard getPieces(int color) const
+        {
+            return pieces[color][0] | pieces[color][1] | pieces[color][2];
+        }
+    };
+
+    constexpr int KING_STEPS[8][2] = { {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1} };
+    constexpr int KNIGHT_STEPS[8][2] = { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} };
+
+    Bitboard getStepAttacks(Square square, const int (&steps)[8][2])
+    {
+        Bitboard attacks = EMPTY_BITBOARD;
+        for (const auto& step : steps) {
+            const int x = squareX(square) + step[0];
+            const int y = squareY(square) + step[1];
+            if (x >= 0 && x < 8 && y >= 0 && y < 8)
+                attacks |= squareBit(makeSquare(x, y));
+        }
+        return attacks;
+    }
+
+    Bitboard getReferenceAttacks(const ReferenceNode& node, int type, Square square)
+    {
+        switch (static_cast<PieceType>(type)) {
+        case PieceType::King:
+            return getStepAttacks(square, KING_STEPS);
+        case PieceType::Knight:
+            return getStepAttacks(square, KNIGHT_STEPS);
+        default:
+            return slidingRookAttacks(square, node.getPieces(0) | node.getPieces(1));
+        }
+    }
+
+    // Scans every enemy piece : no attack map, no attacker lookup.
+    bool isReferenceKingAttacked(const ReferenceNode& node, int color)
+    {
+        const Bitboard king = node.pieces[color][toIndex(PieceType::King)];
+        for (int type = 0; type < NUMBER_OF_PIECE_TYPES; ++type) {
+            Bitboard pieces = node.pieces[1 - color][type];
+            while (pieces)
+                if (getReferenceAttacks(node, type, popLowestSquare(pieces)) & king)
+                    return true;
+        }
+        return false;
+    }
+
+    void playReferenceMove(ReferenceNode& node, Move move)
+    {
+        const Bitboard from = squareBit(move.getFrom());
+        const Bitboard to = squareBit(move.getTo());
+
+        for (Bitboard& pieces : node.pieces[1 - node.sideToMove])
+            pieces &= ~to;
+        for (Bitboard& pieces : node.pieces[node.sideToMove])
+            if (pieces & from)
+                pieces ^= from | to;
+        node.sideToMove = 1 - node.sideToMove;
+    }
+
+    void generateReferenceMoves(const ReferenceNode& node, MoveList& moves)
+    {
+        const int us = node.sideToMove;
+        const Bitboard own = node.getPieces(us);
+        const Bitboard enemies = node.getPieces(1 - us);
+
+        for (int type = 0; type < NUMBER_OF_PIECE_TYPES; ++type) {
+            Bitboard pieces = node.pieces[us][type];
+            while (pieces) {
+                const Square from = popLowestSquare(pieces);
+                Bitboard targets = getReferenceAttacks(node, type, from) & ~own;
+                while (targets) {
+                    const Square to = popLowestSquare(targets);
+                    const Move move(from, to, (enemies & squareBit(to)) ? MoveFlag::Capture : MoveFlag::Quiet);
+
+                    ReferenceNode child = node;
+                    playReferenceMove(child, move);
+                    if (!isReferenceKingAttacked(child, us))
+                        moves.add(move);
+                }
+            }
+        }
+    }
+
+    std::uint64_t countReferenceNodes(const ReferenceNode& node, int depth)
+    {
+        if (depth <= 0)
+            return 1;
+
+        MoveList moves;
+        generateReferenceMoves(node, moves);
+        if (depth == 1)
+            return moves.size();
+
+        std::uint64_t nodes = 0;
+        for (const Move& move : moves) {
+            ReferenceNode child = node;
+            playReferenceMove(child, move);
+            nodes += countReferenceNodes(child, depth - 1);
+        }
+        return nodes;
+    }
+
+    ReferenceNode toReferenceNode(const Position& position)
+    {
+        ReferenceNode node;
+        for (Color color : { Color::Black, Color::White })
+            for (PieceType type : { PieceType::King, PieceType::Rook, PieceType::Knight })
+                node.pieces[toIndex(color)][toIndex(type)] = position.getPieces(color, type);
+        node.sideToMove = toIndex(position.getSideToMove());
+        return node;
+    }
+}
+
+config::PerftTable::PerftTable(std::size_t megabytes)
+{
+    if (megabytes == 0)
+        throw std::invalid_argument("La table de perft doit faire au moins 1 Mo");
+
+    std::size_t count = 1;
+    while (count * 2 * sizeof(Entry) <= (megabytes << 20))
+        count *= 2;
+
+    entries_ = std::make_unique<Entry[]>(count);
+    mask_ = count - 1;
+    for (std::size_t index = 0; index < count; ++index) {
+        entries_[index].check.store(0, std::memory_order_relaxed);
+        entries_[index].nodes.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool config::PerftTable::probe(Key key, int depth, std::uint64_t& nodes) const
+{
+    const Key depthKey = getDepthKey(key, depth);
+    const Entry& entry = entries_[depthKey & mask_];
+    const std::uint64_t stored = entry.nodes.load(std::memory_order_relaxed);
+
+    if (stored == 0 || (entry.check.load(std::memory_order_relaxed) ^ stored) != depthKey)
+        return false;
+    nodes = stored;
+    return true;
+}
+
+void config::PerftTable::store(Key key, int depth, std::uint64_t nodes)
+{
+    const Key depthKey = getDepthKey(key, depth);
+    Entry& entry = entries_[depthKey & mask_];
+
+    entry.check.store(depthKey ^ nodes, std::memory_order_relaxed);
+    entry.nodes.store(nodes, std::memory_order_relaxed);
+}
+
+config::Key config::PerftTable::getDepthKey(Key key, int depth)
+{
+    return key ^ (static_cast<Key>(depth) * 0x9E3779B97F4A7C15ULL);
+}
+
+std::uint64_t config::perft(Position& position, int depth, PerftTable* table)
+{
+    std::uint64_t nodes = 0;
+    if (depth >= 2 && table && table->probe(position.hash(), depth, nodes))
+        return nodes;
+
+    MoveList moves;
+    generateLegal(position, moves);
+
+    if (depth <= 1)
+        return depth == 1 ? moves.size() : 1;
+
+    for (const Move& move : moves) {
+        position.makeMove(move);
+        nodes += perft(position, depth - 1, table);
+        position.unmakeMove();
+    }
+
+    if (table)
+        table->store(position.hash(), depth, nodes);
+    return nodes;
+}
+
+std::vector<std::pair<config::Move, std::uint64_t>> config::divide(const Position& root, int depth, int threads, PerftTable* table)
+{
+    struct Task {
+        int rootIndex;
+        Move reply;
+    };
+
+    Position position = root;
+    MoveList rootMoves;
+    generateLegal(position, rootMoves);
+
+    // Splitting on the replies keeps every thread busy even with few root moves.
+    std::vector<Task> tasks;
+    for (int index = 0; index < rootMoves.size(); ++index) {
+        if (depth < 3) {
+            tasks.push_back({ index, NULL_MOVE });
+            continue;
+        }
+
+        MoveList replies;
+        position.makeMove(rootMoves[index]);
+        generateLegal(position, replies);
+        position.unmakeMove();
+        for (const Move& reply : replies)
+            tasks.push_back({ index, reply });
+    }
+
+    std::vector<std::atomic<std::uint64_t>> counts(rootMoves.size());
+    std::atomic<std::size_t> nextTask{ 0 };
+
+    auto work = [&] {
+        Position local = root;
+        for (std::size_t task = nextTask++; task < tasks.size(); task = nextTask++) {
+            const Task& current = tasks[task];
+            local.makeMove(rootMoves[current.rootIndex]);
+
+            std::uint64_t nodes;
+            if (current.reply.isNull()) {
+                nodes = perft(local, depth - 1, table);
+            }
+            else {
+                local.makeMove(current.reply);
+                nodes = perft(local, depth - 2, table);
+                local.unmakeMove();
+            }
+
+            local.unmakeMove();
+            counts[current.rootIndex] += nodes;
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for (int thread = 1; thread < threads; ++thread)
+        helpers.emplace_back(work);
+    work();
+    for (std::thread& helper : helpers)
+        helper.join();
+
+    std::vector<std::pair<Move, std::uint64_t>> result;
+    for (int index = 0; index < rootMoves.size(); ++index)
+        result.push_back({ rootMoves[index], counts[index].load() });
+    return result;
+}
+
+void config::generateReference(const Position& position, MoveList& moves)
+{
+    generateReferenceMoves(toReferenceNode(position), moves);
+}
+
+std::uint64_t config::referencePerft(const Position& position, int depth)
+{
+    return countReferenceNodes(toReferenceNode(position), depth);
+}
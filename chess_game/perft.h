@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "move.h"
+#include "position.h"
+
+namespace config {
+//Subtree counts memoized by (Zobrist key, depth). One entry per slot, always replaced ;
+//the check word is the key XORed with the count, so a torn write reads as a miss.
+    class PerftTable {
+    public:
+        explicit PerftTable(std::size_t megabytes);
+
+        bool probe(Key, int depth, std::uint64_t& nodes) const;
+        void store(Key, int depth, std::uint64_t nodes);
+
+    private:
+        struct Entry {
+            std::atomic<std::uint64_t> check;
+            std::atomic<std::uint64_t> nodes;
+        };
+
+        static Key getDepthKey(Key, int depth);
+
+        std::unique_ptr<Entry[]> entries_;
+        std::size_t mask_ = 0;
+    };
+
+    // Number of leaf nodes of the legal move tree, depth plies below the position.
+    std::uint64_t perft(Position&, int depth, PerftTable* table = nullptr);
+
+    // Leaf count below each legal root move. The work is split two plies deep over `threads` threads.
+    std::vector<std::pair<Move, std::uint64_t>> divide(const Position&, int depth, int threads = 1, PerftTable* table = nullptr);
+
+    // Reference for the generator, sharing no code with movegen nor Position::makeMove : every pseudo-legal move,
+    // rook rays walked square by square, kept when no enemy piece attacks the king once it is played. Slow.
+    void generateReference(const Position&, MoveList&);
+    std::uint64_t referencePerft(const Position&, int depth);
+}
@@ -7,15 +7,30 @@ config::Color config::Piece::getColor() const
     return color_;
 }
 
-bool config::Piece::isInsideBounds(const std::pair<int, int>& move) const
+void config::Piece::calculatePossibleSimpleMovements(Square from, Board* board, MoveList& moves) const
 {
-    if (move.first >= 0 && move.first <= (BOARD_DIMENSION_X - 1) && move.second >= 0 && move.second <= (BOARD_DIMENSION_Y - 1))
-        return true;
-    return false;
+    generateLegal(board->getPosition(), moves, squareBit(from));
+}
 
+char config::getPieceName(Color color, PieceType type)
+{
+    switch (type) {
+    case PieceType::King: return color == Color::White ? WHITE_KING : BLACK_KING;
+    case PieceType::Rook: return color == Color::White ? WHITE_ROOK : BLACK_ROOK;
+    case PieceType::Knight: return color == Color::White ? WHITE_KNIGHT : BLACK_KNIGHT;
+    }
+    return EMPTY_PIECE;
 }
 
-void config::Piece::setColor(const Color& color)
+bool config::parsePieceName(char name, Color& color, PieceType& type)
 {
-    color_ = color;
-}
\ No newline at end of file
+    switch (name) {
+    case WHITE_KING: color = Color::White; type = PieceType::King; return true;
+    case BLACK_KING: color = Color::Black; type = PieceType::King; return true;
+    case WHITE_ROOK: color = Color::White; type = PieceType::Rook; return true;
+    case BLACK_ROOK: color = Color::Black; type = PieceType::Rook; return true;
+    case WHITE_KNIGHT: color = Color::White; type = PieceType::Knight; return true;
+    case BLACK_KNIGHT: color = Color::Black; type = PieceType::Knight; return true;
+    }
+    return false;
+}
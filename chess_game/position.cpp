@@ -0,0 +1,588 @@
+#include "position.h"
+#include "attacks.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <initializer_list>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+#if defined(CHESSCORE_VERIFY_HASH)
+    constexpr bool VERIFY_HASH = true;
+#else
+    constexpr bool VERIFY_HASH = false;
+#endif
+
+    using namespace config;
+
+    // One byte per bit of a rank : adding BYTE_SPREAD[rank bits] to a rank word of counts adds one to each square.
+    constexpr std::array<std::uint64_t, 256> makeByteSpread()
+    {
+        std::array<std::uint64_t, 256> spread{};
+        for (int bits = 0; bits < 256; ++bits)
+            for (int file = 0; file < 8; ++file)
+                if (bits & (1 << file))
+                    spread[bits] |= std::uint64_t(1) << (8 * file);
+        return spread;
+    }
+
+    constexpr std::array<std::uint64_t, 256> BYTE_SPREAD = makeByteSpread();
+
+    constexpr int BOTH_COLORS = (1 << NUMBER_OF_COLORS) - 1;
+}
+
+config::Position::Position()
+{
+    clear();
+}
+
+void config::Position::clear()
+{
+    for (auto& colorPieces : pieces_)
+        for (auto& pieces : colorPieces)
+            pieces = EMPTY_BITBOARD;
+    for (auto& pieces : colors_)
+        pieces = EMPTY_BITBOARD;
+    for (Square& square : kingSquares_)
+        square = NO_SQUARE;
+    for (Bitboard& attacks : pieceAttacks_)
+        attacks = EMPTY_BITBOARD;
+    for (auto& counts : attackerCounts_)
+        for (std::uint64_t& rank : counts)
+            rank = 0;
+    for (Bitboard& attacked : attacked_)
+        attacked = EMPTY_BITBOARD;
+    sideToMove_ = Color::White;
+    check_ = false;
+    hash_ = 0;
+    material_ = 0;
+    ply_ = 0;
+}
+
+void config::Position::setFen(const std::string& fen)
+{
+    std::istringstream stream(fen);
+    std::string placement;
+    std::string side = "w";
+    stream >> placement >> side;
+
+    Position position;
+    int x = 0;
+    int y = 0;
+    for (char name : placement) {
+        if (name == '/') {
+            if (x != 8 || ++y > 7)
+                throw std::invalid_argument("FEN invalide : rangée incomplète");
+            x = 0;
+        }
+        else if (name >= '1' && name <= '8') {
+            x += name - '0';
+        }
+        else {
+            PieceType type;
+            switch (std::tolower(static_cast<unsigned char>(name))) {
+            case 'k': type = PieceType::King; break;
+            case 'r': type = PieceType::Rook; break;
+            case 'n': type = PieceType::Knight; break;
+            default: throw std::invalid_argument(std::string("FEN invalide : pièce inconnue ") + name);
+            }
+            if (x > 7)
+                throw std::invalid_argument("FEN invalide : rangée trop longue");
+            position.addPiece(std::isupper(static_cast<unsigned char>(name)) ? Color::White : Color::Black, type, makeSquare(x++, y));
+        }
+        if (x > 8)
+            throw std::invalid_argument("FEN invalide : rangée trop longue");
+    }
+    if (x != 8 || y != 7)
+        throw std::invalid_argument("FEN invalide : il faut huit rangées");
+
+    if (side != "w" && side != "b")
+        throw std::invalid_argument("FEN invalide : trait inconnu " + side);
+    if (popCount(position.getPieces(Color::White, PieceType::King)) != 1 || popCount(position.getPieces(Color::Black, PieceType::King)) != 1)
+        throw std::invalid_argument("FEN invalide : il faut un roi de chaque couleur");
+
+    position.setSideToMove(side == "w" ? Color::White : Color::Black);
+    position.setCheckState(position.isInCheck(position.getSideToMove()));
+    *this = position;
+}
+
+std::string config::Position::getFen() const
+{
+    std::string fen;
+
+    for (int y = 0; y < 8; ++y) {
+        int empty = 0;
+        for (int x = 0; x < 8; ++x) {
+            Color color;
+            PieceType type;
+            if (!getPieceAt(makeSquare(x, y), color, type)) {
+                ++empty;
+                continue;
+            }
+            if (empty)
+                fen += static_cast<char>('0' + empty);
+            empty = 0;
+
+            const char name = type == PieceType::King ? 'k' : (type == PieceType::Rook ? 'r' : 'n');
+            fen += color == Color::White ? static_cast<char>(std::toupper(name)) : name;
+        }
+        if (empty)
+            fen += static_cast<char>('0' + empty);
+        if (y < 7)
+            fen += '/';
+    }
+    return fen + (sideToMove_ == Color::White ? " w - - 0 1" : " b - - 0 1");
+}
+
+void config::Position::addPiece(Color color, PieceType type, Square square)
+{
+    if (isOccupied(square))
+        removePiece(square);
+
+    pieces_[toIndex(color)][toIndex(type)] |= squareBit(square);
+    colors_[toIndex(color)] |= squareBit(square);
+    hash_ ^= zobristPiece(toIndex(color), toIndex(type), square);
+    material_ += getMaterialUnit(color, type);
+    if (type == PieceType::King)
+        kingSquares_[toIndex(color)] = square;
+    updateRookAttacks(squareBit(square));
+    setPieceAttacks(toIndex(color), square, getPieceAttacks(toIndex(color), square));
+    updateAttackedSquares(BOTH_COLORS);
+}
+
+void config::Position::setPieces(int count, const Color* colors, const PieceType* types, const Square* squares)
+{
+    clear();
+    for (int piece = 0; piece < count; ++piece) {
+        const int color = toIndex(colors[piece]);
+        const int type = toIndex(types[piece]);
+        pieces_[color][type] |= squareBit(squares[piece]);
+        colors_[color] |= squareBit(squares[piece]);
+        hash_ ^= zobristPiece(color, type, squares[piece]);
+        material_ += getMaterialUnit(colors[piece], types[piece]);
+        if (types[piece] == PieceType::King)
+            kingSquares_[color] = squares[piece];
+    }
+
+    for (int color = 0; color < NUMBER_OF_COLORS; ++color) {
+        Bitboard pieces = colors_[color];
+        while (pieces) {
+            const Square square = popLowestSquare(pieces);
+            setPieceAttacks(color, square, getPieceAttacks(color, square));
+        }
+    }
+    updateAttackedSquares(BOTH_COLORS);
+}
+
+void config::Position::removePiece(Square square)
+{
+    Color color;
+    PieceType type;
+    if (!getPieceAt(square, color, type))
+        return;
+
+    pieces_[toIndex(color)][toIndex(type)] ^= squareBit(square);
+    colors_[toIndex(color)] ^= squareBit(square);
+    hash_ ^= zobristPiece(toIndex(color), toIndex(type), square);
+    material_ -= getMaterialUnit(color, type);
+    if (type == PieceType::King) {
+        const Bitboard kings = pieces_[toIndex(color)][toIndex(PieceType::King)];
+        kingSquares_[toIndex(color)] = kings ? lowestSquare(kings) : NO_SQUARE;
+    }
+    setPieceAttacks(toIndex(color), square, EMPTY_BITBOARD);
+    updateRookAttacks(squareBit(square));
+    updateAttackedSquares(BOTH_COLORS);
+}
+
+void config::Position::movePiece(Square from, Square to)
+{
+    Color color;
+    PieceType type;
+    if (!getPieceAt(from, color, type))
+        return;
+
+    removePiece(from);
+    addPiece(color, type, to);
+}
+
+void config::Position::makeMove(Move move)
+{
+    const Square from = move.getFrom();
+    const Square to = move.getTo();
+    const Bitboard fromTo = squareBit(from) | squareBit(to);
+    const int us = toIndex(sideToMove_);
+    const int them = toIndex(opposite(sideToMove_));
+
+    if (ply_ == MAX_PLY)
+        throw std::length_error("Historique des coups plein : " + std::to_string(MAX_PLY) + " coups déjà joués");
+
+    UndoState& undo = history_[ply_++];
+    undo.move = move;
+    undo.check = check_;
+    undo.hash = hash_;
+    undo.hasCaptured = false;
+
+    if (colors_[them] & squareBit(to)) {
+        for (int type = 0; type < NUMBER_OF_PIECE_TYPES; ++type) {
+            if (pieces_[them][type] & squareBit(to)) {
+                pieces_[them][type] ^= squareBit(to);
+                hash_ ^= zobristPiece(them, type, to);
+                undo.hasCaptured = true;
+                undo.captured = static_cast<PieceType>(type);
+                material_ -= getMaterialUnit(opposite(sideToMove_), undo.captured);
+                if (type == toIndex(PieceType::King))
+                    kingSquares_[them] = pieces_[them][type] ? lowestSquare(pieces_[them][type]) : NO_SQUARE;
+                break;
+            }
+        }
+        colors_[them] ^= squareBit(to);
+    }
+
+    PieceType moved = PieceType::King;
+    for (int type = 0; type < NUMBER_OF_PIECE_TYPES; ++type) {
+        if (pieces_[us][type] & squareBit(from)) {
+            pieces_[us][type] ^= fromTo;
+            hash_ ^= zobristPiece(us, type, from) ^ zobristPiece(us, type, to);
+            moved = static_cast<PieceType>(type);
+            if (type == toIndex(PieceType::King))
+                kingSquares_[us] = to;
+            break;
+        }
+    }
+    colors_[us] ^= fromTo;
+
+    if (undo.hasCaptured)
+        setPieceAttacks(them, to, EMPTY_BITBOARD);
+    const Bitboard before = pieceAttacks_[from];
+    pieceAttacks_[from] = EMPTY_BITBOARD;
+    pieceAttacks_[to] = getPieceAttacks(us, moved, to);
+    changeAttacks(us, before, pieceAttacks_[to]);
+    updateAttackedSquares((1 << us) | (undo.hasCaptured << them) | updateRookAttacks(fromTo));
+
+    sideToMove_ = opposite(sideToMove_);
+    hash_ ^= ZOBRIST_BLACK_TO_MOVE;
+    check_ = isInCheck(sideToMove_);
+
+    if (VERIFY_HASH) {
+        verifyHash();
+        verifyAttacks();
+    }
+}
+
+void config::Position::unmakeMove()
+{
+    const UndoState& undo = history_[--ply_];
+    const Square from = undo.move.getFrom();
+    const Square to = undo.move.getTo();
+    const Bitboard fromTo = squareBit(from) | squareBit(to);
+
+    sideToMove_ = opposite(sideToMove_);
+    check_ = undo.check;
+    hash_ = undo.hash;
+
+    const int us = toIndex(sideToMove_);
+    const int them = toIndex(opposite(sideToMove_));
+
+    PieceType moved = PieceType::King;
+    for (int type = 0; type < NUMBER_OF_PIECE_TYPES; ++type) {
+        if (pieces_[us][type] & squareBit(to)) {
+            pieces_[us][type] ^= fromTo;
+            moved = static_cast<PieceType>(type);
+            if (type == toIndex(PieceType::King))
+                kingSquares_[us] = from;
+            break;
+        }
+    }
+    colors_[us] ^= fromTo;
+
+    if (undo.hasCaptured) {
+        pieces_[them][toIndex(undo.captured)] |= squareBit(to);
+        colors_[them] |= squareBit(to);
+        material_ += getMaterialUnit(opposite(sideToMove_), undo.captured);
+        if (undo.captured == PieceType::King)
+            kingSquares_[them] = to;
+    }
+
+    // The same two squares change back : the rooks whose rays makeMove cut or extended are recomputed the same way.
+    const Bitboard before = pieceAttacks_[to];
+    pieceAttacks_[to] = EMPTY_BITBOARD;
+    pieceAttacks_[from] = getPieceAttacks(us, moved, from);
+    changeAttacks(us, before, pieceAttacks_[from]);
+    if (undo.hasCaptured)
+        setPieceAttacks(them, to, getPieceAttacks(them, undo.captured, to));
+    updateAttackedSquares((1 << us) | (undo.hasCaptured << them) | updateRookAttacks(fromTo));
+
+    if (VERIFY_HASH) {
+        verifyHash();
+        verifyAttacks();
+    }
+}
+
+int config::Position::getPly() const
+{
+    return ply_;
+}
+
+void config::Position::clearHistory()
+{
+    ply_ = 0;
+}
+
+bool config::Position::isRepetition() const
+{
+    for (int ply = ply_ - 2; ply >= 0; ply -= 2)
+        if (history_[ply].hash == hash_)
+            return true;
+    return false;
+}
+
+bool config::Position::isInsufficientMaterial() const
+{
+    // Two kings and no other piece, or exactly one knight
+    constexpr MaterialKey kings = getMaterialUnit(Color::White, PieceType::King) + getMaterialUnit(Color::Black, PieceType::King);
+    return material_ == kings
+        || material_ == kings + getMaterialUnit(Color::White, PieceType::Knight)
+        || material_ == kings + getMaterialUnit(Color::Black, PieceType::Knight);
+}
+
+config::MaterialKey config::Position::getMaterialKey() const
+{
+    return material_;
+}
+
+int config::Position::getPieceCount(Color color, PieceType type) const
+{
+    return static_cast<int>((material_ >> getMaterialShift(color, type)) & 0xFF);
+}
+
+config::Bitboard config::Position::getPieces(Color color, PieceType type) const
+{
+    return pieces_[toIndex(color)][toIndex(type)];
+}
+
+config::Bitboard config::Position::getPieces(Color color) const
+{
+    return colors_[toIndex(color)];
+}
+
+config::Bitboard config::Position::getOccupancy() const
+{
+    return colors_[toIndex(Color::Black)] | colors_[toIndex(Color::White)];
+}
+
+bool config::Position::isOccupied(Square square) const
+{
+    return (getOccupancy() & squareBit(square)) != EMPTY_BITBOARD;
+}
+
+bool config::Position::getPieceAt(Square square, Color& color, PieceType& type) const
+{
+    const Bitboard bit = squareBit(square);
+
+    for (Color c : { Color::Black, Color::White }) {
+        if (!(colors_[toIndex(c)] & bit))
+            continue;
+        for (PieceType t : { PieceType::King, PieceType::Rook, PieceType::Knight }) {
+            if (pieces_[toIndex(c)][toIndex(t)] & bit) {
+                color = c;
+                type = t;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+config::Bitboard config::Position::getAttackers(Square square, Color by, Bitboard occupancy) const
+{
+    const int color = toIndex(by);
+
+    return (kingAttacks(square) & pieces_[color][toIndex(PieceType::King)])
+        | (knightAttacks(square) & pieces_[color][toIndex(PieceType::Knight)])
+        | (rookAttacks(square, occupancy) & pieces_[color][toIndex(PieceType::Rook)]);
+}
+
+bool config::Position::isAttacked(Square square, Color by) const
+{
+    return getAttackers(square, by, getOccupancy()) != EMPTY_BITBOARD;
+}
+
+bool config::Position::isInCheck(Color color) const
+{
+    return (pieces_[toIndex(color)][toIndex(PieceType::King)] & attacked_[toIndex(opposite(color))]) != EMPTY_BITBOARD;
+}
+
+config::Bitboard config::Position::getAttackedSquares(Color color) const
+{
+    return attacked_[toIndex(color)];
+}
+
+int config::Position::getAttackerCount(Square square, Color by) const
+{
+    return (attackerCounts_[toIndex(by)][square >> 3] >> (8 * (square & 7))) & 0xFF;
+}
+
+config::Square config::Position::getKingSquare(Color color) const
+{
+    return kingSquares_[toIndex(color)];
+}
+
+config::Color config::Position::getSideToMove() const
+{
+    return sideToMove_;
+}
+
+void config::Position::setSideToMove(Color color)
+{
+    if (color != sideToMove_)
+        hash_ ^= ZOBRIST_BLACK_TO_MOVE;
+    sideToMove_ = color;
+}
+
+bool config::Position::getCheckState() const
+{
+    return check_;
+}
+
+void config::Position::setCheckState(bool check)
+{
+    check_ = check;
+}
+
+config::Key config::Position::hash() const
+{
+    return hash_;
+}
+
+config::Key config::Position::computeHash() const
+{
+    Key key = sideToMove_ == Color::Black ? ZOBRIST_BLACK_TO_MOVE : 0;
+
+    for (int color = 0; color < NUMBER_OF_COLORS; ++color) {
+        for (int type = 0; type < NUMBER_OF_PIECE_TYPES; ++type) {
+            Bitboard pieces = pieces_[color][type];
+            while (pieces)
+                key ^= zobristPiece(color, type, popLowestSquare(pieces));
+        }
+    }
+    return key;
+}
+
+void config::Position::verifyHash() const
+{
+    if (hash_ != computeHash())
+        throw std::logic_error("Clé de hachage incohérente avec la position");
+
+    MaterialKey material = 0;
+    for (Color color : { Color::Black, Color::White })
+        for (PieceType type : { PieceType::King, PieceType::Rook, PieceType::Knight })
+            material += popCount(getPieces(color, type)) * getMaterialUnit(color, type);
+    if (material != material_)
+        throw std::logic_error("Clé de matériel incohérente avec la position");
+}
+
+void config::Position::verifyAttacks() const
+{
+    for (int color = 0; color < NUMBER_OF_COLORS; ++color) {
+        int counts[64] = {};
+        Bitboard pieces = colors_[color];
+        while (pieces) {
+            Bitboard attacks = getPieceAttacks(color, popLowestSquare(pieces));
+            while (attacks)
+                ++counts[popLowestSquare(attacks)];
+        }
+
+        for (Square square = 0; square < 64; ++square) {
+            const bool attacked = (attacked_[color] >> square) & 1;
+            if (counts[square] != getAttackerCount(square, static_cast<Color>(color)) || (counts[square] != 0) != attacked)
+                throw std::logic_error("Cases attaquées incohérentes avec la position");
+        }
+    }
+}
+
+config::Bitboard config::Position::getPieceAttacks(int color, PieceType type, Square square) const
+{
+    switch (type) {
+    case PieceType::King:
+        return kingAttacks(square);
+    case PieceType::Knight:
+        return knightAttacks(square);
+    default:
+        return getRookAttacks(color, square);
+    }
+}
+
+config::Bitboard config::Position::getPieceAttacks(int color, Square square) const
+{
+    const Bitboard bit = squareBit(square);
+    if (pieces_[color][toIndex(PieceType::Knight)] & bit)
+        return knightAttacks(square);
+    if (pieces_[color][toIndex(PieceType::King)] & bit)
+        return kingAttacks(square);
+    return getRookAttacks(color, square);
+}
+
+config::Bitboard config::Position::getRookOccupancy(int color) const
+{
+    return getOccupancy() & ~pieces_[1 - color][toIndex(PieceType::King)];
+}
+
+config::Bitboard config::Position::getRookAttacks(int color, Square square) const
+{
+    // Rook rays go through the enemy king, which cannot hide behind itself.
+    return rookAttacks(square, getRookOccupancy(color));
+}
+
+void config::Position::setPieceAttacks(int color, Square square, Bitboard attacks)
+{
+    changeAttacks(color, pieceAttacks_[square], attacks);
+    pieceAttacks_[square] = attacks;
+}
+
+void config::Position::changeAttacks(int color, Bitboard before, Bitboard after)
+{
+    // Adding first keeps every byte from going below zero and borrowing from its neighbour.
+    for (int rank = 0; rank < 8; ++rank) {
+        attackerCounts_[color][rank] += BYTE_SPREAD[(after >> (8 * rank)) & 0xFF];
+        attackerCounts_[color][rank] -= BYTE_SPREAD[(before >> (8 * rank)) & 0xFF];
+    }
+}
+
+void config::Position::updateAttackedSquares(int colors)
+{
+    // A count stays below 128 : adding 0x7F sets the high bit of a byte exactly when it is not zero, and the
+    // multiplication gathers the eight high bits of a rank into its top byte.
+    for (int color = 0; color < NUMBER_OF_COLORS; ++color) {
+        if (!(colors & (1 << color)))
+            continue;
+
+        Bitboard attacked = EMPTY_BITBOARD;
+        for (int rank = 0; rank < 8; ++rank) {
+            const std::uint64_t nonZero = ((attackerCounts_[color][rank] + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
+            attacked |= ((nonZero * 0x0102040810204080ULL) >> 56) << (8 * rank);
+        }
+        attacked_[color] = attacked;
+    }
+}
+
+int config::Position::updateRookAttacks(Bitboard changed)
+{
+    int colors = 0;
+    for (int color = 0; color < NUMBER_OF_COLORS; ++color) {
+        Bitboard rooks = pieces_[color][toIndex(PieceType::Rook)] & ~changed;
+        while (rooks) {
+            const Square square = popLowestSquare(rooks);
+            if (!(pieceAttacks_[square] & changed))
+                continue;
+
+            // A ray through the enemy king that moved sees no change.
+            const Bitboard attacks = getRookAttacks(color, square);
+            if (attacks != pieceAttacks_[square]) {
+                setPieceAttacks(color, square, attacks);
+                colors |= 1 << color;
+            }
+        }
+    }
+    return colors;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "bitboard.h"
+#include "move.h"
+#include "zobrist.h"
+
+namespace config {
+    enum class Color { Black, White };
+    enum class PieceType { King, Rook, Knight };
+
+    constexpr int NUMBER_OF_COLORS = 2;
+    constexpr int NUMBER_OF_PIECE_TYPES = 3;
+
+    constexpr Color opposite(Color color)
+    {
+        return color == Color::White ? Color::Black : Color::White;
+    }
+
+    constexpr int toIndex(Color color)
+    {
+        return static_cast<int>(color);
+    }
+
+    constexpr int toIndex(PieceType type)
+    {
+        return static_cast<int>(type);
+    }
+
+    // Number of pieces of each color and type, one byte each : two positions hold the same material
+    // exactly when their keys are equal.
+    using MaterialKey = std::uint64_t;
+
+    // Bit offset of the count of one color and piece type in the material key.
+    constexpr int getMaterialShift(Color color, PieceType type)
+    {
+        return 8 * (NUMBER_OF_PIECE_TYPES * toIndex(color) + toIndex(type));
+    }
+
+    constexpr MaterialKey getMaterialUnit(Color color, PieceType type)
+    {
+        return MaterialKey(1) << getMaterialShift(color, type);
+    }
+
+    constexpr int MAX_PLY = 128;
+
+    // What makeMove overwrites, so that unmakeMove can put it back
+    struct UndoState {
+        Move move;
+        bool hasCaptured;
+        PieceType captured;
+        bool check;
+        Key hash;
+    };
+
+//Compact position : one occupancy mask per (color, piece type)
+    class Position {
+    public:
+        Position();
+
+        void clear();
+        // Piece placement and side to move of a FEN string (K, R, N for white, k, r, n for black) ;
+        // throws std::invalid_argument when it does not describe a position with one king per side.
+        void setFen(const std::string&);
+        std::string getFen() const;
+        void addPiece(Color, PieceType, Square);
+        // Clears the board and places pieces on distinct squares, building the attack maps once at the end.
+        void setPieces(int count, const Color*, const PieceType*, const Square*);
+        void removePiece(Square);
+        void movePiece(Square from, Square to);
+
+        // Plays the move for the side to move and pushes an undo state ; the check flag is recomputed for the opponent.
+        // Throws std::length_error when MAX_PLY moves are already on the stack.
+        void makeMove(Move);
+        void unmakeMove();
+        int getPly() const;
+        void clearHistory();
+        // The current position already occurred since the history was last cleared.
+        bool isRepetition() const;
+        bool isInsufficientMaterial() const;
+        // Kept up to date by every change, like the hash.
+        MaterialKey getMaterialKey() const;
+        int getPieceCount(Color, PieceType) const;
+
+        Bitboard getPieces(Color, PieceType) const;
+        // Squares of the pieces of one side, kept up to date by every change : iterate it as a piece list.
+        Bitboard getPieces(Color) const;
+        // Cached square of the king, NO_SQUARE when the side has none.
+        Square getKingSquare(Color) const;
+        Bitboard getOccupancy() const;
+        bool isOccupied(Square) const;
+        bool getPieceAt(Square, Color&, PieceType&) const;
+        Bitboard getAttackers(Square, Color by, Bitboard occupancy) const;
+        bool isAttacked(Square, Color by) const;
+        bool isInCheck(Color) const;
+        // Squares attacked by a side, with its rook rays continuing past the enemy king : the squares
+        // that king may not step on. Kept up to date by every change, like the attacker counts.
+        Bitboard getAttackedSquares(Color) const;
+        int getAttackerCount(Square, Color by) const;
+
+        Color getSideToMove() const;
+        void setSideToMove(Color);
+        bool getCheckState() const;
+        void setCheckState(bool);
+
+        // Zobrist key of the pieces and the side to move, kept up to date on every change.
+        Key hash() const;
+        Key computeHash() const;
+        // Throws std::logic_error when the incremental key differs from computeHash(), or the material key from the pieces.
+        void verifyHash() const;
+        // Throws std::logic_error when the attack maps differ from a full recomputation.
+        void verifyAttacks() const;
+
+    private:
+        Bitboard getPieceAttacks(int color, Square) const;
+        Bitboard getPieceAttacks(int color, PieceType, Square) const;
+        // Occupancy seen by the rooks of a side : every piece but the enemy king.
+        Bitboard getRookOccupancy(int color) const;
+        Bitboard getRookAttacks(int color, Square) const;
+        // Replaces the attacks of the piece on a square, moving the counts of its side from the old squares to the new.
+        void setPieceAttacks(int color, Square, Bitboard attacks);
+        void changeAttacks(int color, Bitboard before, Bitboard after);
+        // Rebuilds the attacked squares of the sides in the mask (bit toIndex(color)) from their counts,
+        // once a change is complete.
+        void updateAttackedSquares(int colors);
+        // Recomputes the rooks, off the changed squares, whose previous attacks reached one of them : no other
+        // piece sees its attacks change when those squares fill or empty. Returns the mask of the sides whose
+        // attacks changed.
+        int updateRookAttacks(Bitboard changed);
+
+        Bitboard pieces_[NUMBER_OF_COLORS][NUMBER_OF_PIECE_TYPES];
+        Bitboard colors_[NUMBER_OF_COLORS];
+        Square kingSquares_[NUMBER_OF_COLORS];
+        // Attacks of the piece standing on each square, empty on empty squares.
+        Bitboard pieceAttacks_[64];
+        // Number of pieces of each side attacking each square, one byte per square and one word per rank,
+        // and the squares where it is not zero.
+        std::uint64_t attackerCounts_[NUMBER_OF_COLORS][8];
+        Bitboard attacked_[NUMBER_OF_COLORS];
+        Color sideToMove_ = Color::White;
+        bool check_ = false;
+        Key hash_ = 0;
+        MaterialKey material_ = 0;
+        UndoState history_[MAX_PLY];
+        int ply_ = 0;
+    };
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "structure.h"
+
+namespace config {
+    // Starting positions offered by the scenario selector, in Board::create format.
+    struct Scenario {
+        const char* name;
+        std::vector<std::pair<int, int>> positions;
+        std::vector<char> pieces;
+    };
+
+    inline const std::vector<Scenario>& getScenarios()
+    {
+        static const std::vector<Scenario> scenarios = {
+            { "2 tours vs 2 tours",
+                { {1, 3}, {6, 6}, {0, 5}, {7, 0}, {3, 4}, {4, 4} }, {WHITE_ROOK, WHITE_ROOK, WHITE_KING, BLACK_ROOK, BLACK_ROOK, BLACK_KING} },
+            { "2 cavaliers vs 2 cavaliers",
+                { {1, 5}, {6, 6}, {4, 6}, {4, 0}, {2, 3}, {1, 2} }, {WHITE_KNIGHT, WHITE_KNIGHT, WHITE_KING, BLACK_KNIGHT, BLACK_KNIGHT, BLACK_KING} },
+            { "1 cavalier-1 tour vs 2 cavaliers",
+                { {4, 4}, {6, 7}, {4, 7}, {1, 5}, {0, 3}, {2, 0} }, {WHITE_KNIGHT, WHITE_ROOK, WHITE_KING, BLACK_KNIGHT, BLACK_KNIGHT, BLACK_KING} },
+            { "1 cavalier-1 tour vs 2 tours",
+                { {1, 7}, {4, 7}, {2, 6}, {5, 4}, {3, 3}, {2, 0} }, {WHITE_KNIGHT, WHITE_ROOK, WHITE_KING, BLACK_ROOK, BLACK_ROOK, BLACK_KING} },
+            { "1 cavalier-1 tour vs 1 cavalier-1 tour",
+                { {3, 7}, {2, 5}, {5, 7}, {7, 4}, {0, 7}, {1, 2} }, {WHITE_KNIGHT, WHITE_ROOK, WHITE_KING, BLACK_KNIGHT, BLACK_ROOK, BLACK_KING} },
+        };
+        return scenarios;
+    }
+
+    // The pieces of a scenario on a bare position, without a Board.
+    inline Position getScenarioPosition(const Scenario& scenario, Color sideToMove)
+    {
+        Position position;
+        for (std::size_t piece = 0; piece < scenario.positions.size(); ++piece) {
+            Color color;
+            PieceType type;
+            if (parsePieceName(scenario.pieces[piece], color, type))
+                position.addPiece(color, type, makeSquare(scenario.positions[piece].first, scenario.positions[piece].second));
+        }
+        position.setSideToMove(sideToMove);
+        position.setCheckState(position.isInCheck(sideToMove));
+        return position;
+    }
+}
@@ -0,0 +1,359 @@
+#include "search.h"
+#include "attacks.h"
+#include "movegen.h"
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    using namespace config;
+
+    constexpr int PIECE_VALUES[NUMBER_OF_PIECE_TYPES] = { 0, 500, 300 };
+    constexpr int TABLE_MOVE_ORDER = 1 << 20;
+    constexpr int CAPTURE_ORDER = 1 << 16;
+
+    // 0 on the four central squares, 6 in the corners
+    int getCenterDistance(Square square)
+    {
+        return std::max(3 - squareX(square), squareX(square) - 4) + std::max(3 - squareY(square), squareY(square) - 4);
+    }
+
+    int getKingDistance(Square from, Square to)
+    {
+        return std::max(std::abs(squareX(from) - squareX(to)), std::abs(squareY(from) - squareY(to)));
+    }
+
+    int evaluate(const Position& position)
+    {
+        const Color us = position.getSideToMove();
+        const Color them = opposite(us);
+        int material[NUMBER_OF_COLORS] = {};
+
+        for (Color color : { Color::Black, Color::White }) {
+            for (int type = 0; type < NUMBER_OF_PIECE_TYPES; ++type)
+                material[toIndex(color)] += PIECE_VALUES[type] * popCount(position.getPieces(color, static_cast<PieceType>(type)));
+
+            Bitboard knights = position.getPieces(color, PieceType::Knight);
+            while (knights)
+                material[toIndex(color)] += 4 * (6 - getCenterDistance(popLowestSquare(knights)));
+        }
+
+        int score = material[toIndex(us)] - material[toIndex(them)];
+
+        // The side ahead drives the enemy king to the edge and brings its own king closer.
+        const Bitboard ownKing = position.getPieces(us, PieceType::King);
+        const Bitboard enemyKing = position.getPieces(them, PieceType::King);
+        if (score != 0 && ownKing && enemyKing) {
+            const Square strongKing = lowestSquare(score > 0 ? ownKing : enemyKing);
+            const Square weakKing = lowestSquare(score > 0 ? enemyKing : ownKing);
+            const int mopUp = 10 * getCenterDistance(weakKing) + 4 * (7 - getKingDistance(strongKing, weakKing));
+            score += score > 0 ? mopUp : -mopUp;
+        }
+        return score;
+    }
+
+    // Helper threads sort quiet moves by a per-thread hash so that they explore different subtrees first.
+    int getQuietOrder(int threadId, Move move)
+    {
+        if (threadId == 0)
+            return 0;
+
+        std::uint32_t value = (move.getData() + 1u) * 2654435761u ^ static_cast<std::uint32_t>(threadId) * 40503u;
+        value ^= value >> 15;
+        return static_cast<int>(value & 0xFF);
+    }
+
+    // Mate scores are stored relative to the node, not to the root.
+    int scoreToTable(int score, int ply)
+    {
+        if (score >= MATE_BOUND)
+            return score + ply;
+        if (score <= -MATE_BOUND)
+            return score - ply;
+        return score;
+    }
+
+    int scoreFromTable(int score, int ply)
+    {
+        if (score >= MATE_BOUND)
+            return score - ply;
+        if (score <= -MATE_BOUND)
+            return score + ply;
+        return score;
+    }
+}
+
+bool config::isMateScore(int score)
+{
+    return std::abs(score) >= MATE_BOUND;
+}
+
+int config::getMateDistance(int score)
+{
+    if (score > 0)
+        return (MATE_SCORE - score + 1) / 2;
+    return -(MATE_SCORE + score) / 2;
+}
+
+config::Search::Search(TranspositionTable& table, int threads) :
+    table_(table)
+{
+    if (threads < 1)
+        throw std::invalid_argument("La recherche demande au moins un thread");
+
+    for (int id = 0; id < threads; ++id) {
+        threads_.push_back(std::make_unique<Thread>());
+        threads_.back()->id = id;
+    }
+}
+
+config::SearchResult config::Search::run(const Position& position, const SearchLimits& limits, const IterationCallback& onIteration)
+{
+    limits_ = limits;
+    stopped_ = false;
+    start_ = std::chrono::steady_clock::now();
+    table_.newSearch();
+
+    for (auto& thread : threads_) {
+        thread->position = position;
+        thread->position.clearHistory();
+        thread->nodes = 0;
+    }
+
+    std::vector<std::thread> helpers;
+    for (std::size_t index = 1; index < threads_.size(); ++index)
+        helpers.emplace_back([this, index] { iterate(*threads_[index], nullptr); });
+
+    SearchResult result = iterate(*threads_.front(), &onIteration);
+
+    stopped_ = true;
+    for (std::thread& helper : helpers)
+        helper.join();
+
+    result.nodes = getNodes();
+    result.seconds = getElapsedSeconds();
+    return result;
+}
+
+void config::Search::stop()
+{
+    stopped_ = true;
+}
+
+int config::Search::getThreadCount() const
+{
+    return static_cast<int>(threads_.size());
+}
+
+config::SearchResult config::Search::iterate(Thread& thread, const IterationCallback* onIteration)
+{
+    SearchResult result;
+    const int maxDepth = limits_.depth > 0 ? std::min(limits_.depth, MAX_PLY - 1) : MAX_PLY - 1;
+
+    // Every other helper runs one ply ahead of the main thread.
+    for (int depth = 1 + (thread.id & 1); depth <= maxDepth; ++depth) {
+        const int score = negamax(thread, depth, -INFINITE_SCORE, INFINITE_SCORE, 0);
+
+        // An interrupted iteration is only kept when nothing better exists.
+        if (stopped_ && !result.bestMove.isNull())
+            break;
+
+        result.score = score;
+        result.depth = depth;
+        result.pv.assign(thread.pv[0], thread.pv[0] + thread.pvLength[0]);
+        result.bestMove = result.pv.empty() ? NULL_MOVE : result.pv.front();
+        result.nodes = getNodes();
+        result.seconds = getElapsedSeconds();
+
+        if (onIteration && *onIteration)
+            (*onIteration)(result);
+
+        // Stop once a mate is proven within the searched depth.
+        if (stopped_ || (isMateScore(score) && MATE_SCORE - std::abs(score) <= depth))
+            break;
+    }
+    return result;
+}
+
+int config::Search::negamax(Thread& thread, int depth, int alpha, int beta, int ply)
+{
+    Position& position = thread.position;
+    thread.pvLength[ply] = ply;
+
+    if (shouldStop(thread))
+        return 0;
+    if (ply > 0 && (position.isRepetition() || position.isInsufficientMaterial()))
+        return 0;
+    if (ply >= MAX_PLY - 1)
+        return evaluate(position);
+
+    const bool inCheck = getCheckers(position) != EMPTY_BITBOARD;
+    if (inCheck)
+        ++depth;
+    if (depth <= 0)
+        return quiesce(thread, alpha, beta, ply);
+
+    thread.nodes.store(thread.nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    const Key key = position.hash();
+    const int originalAlpha = alpha;
+    Move tableMove = NULL_MOVE;
+    TTData entry;
+    if (table_.probe(key, entry)) {
+        tableMove = entry.move;
+        const int score = scoreFromTable(entry.score, ply);
+        if (ply > 0 && entry.depth >= depth
+            && (entry.bound == Bound::Exact
+                || (entry.bound == Bound::Lower && score >= beta)
+                || (entry.bound == Bound::Upper && score <= alpha)))
+            return score;
+    }
+
+    MoveList moves;
+    generateLegal(position, moves);
+    if (moves.empty())
+        return inCheck ? -MATE_SCORE + ply : 0;
+
+    orderMoves(thread, moves, tableMove);
+
+    Move bestMove = NULL_MOVE;
+    int bestScore = -INFINITE_SCORE;
+    for (const Move& move : moves) {
+        position.makeMove(move);
+        const int score = -negamax(thread, depth - 1, -beta, -alpha, ply + 1);
+        position.unmakeMove();
+
+        if (stopped_)
+            return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+            if (score > alpha) {
+                alpha = score;
+                updatePv(thread, ply, move);
+                if (alpha >= beta)
+                    break;
+            }
+        }
+    }
+
+    const Bound bound = bestScore >= beta ? Bound::Lower : (bestScore > originalAlpha ? Bound::Exact : Bound::Upper);
+    table_.store(key, { bestMove, scoreToTable(bestScore, ply), depth, bound });
+    return bestScore;
+}
+
+int config::Search::quiesce(Thread& thread, int alpha, int beta, int ply)
+{
+    Position& position = thread.position;
+    thread.pvLength[ply] = ply;
+
+    if (shouldStop(thread))
+        return 0;
+    if (position.isInsufficientMaterial())
+        return 0;
+
+    thread.nodes.store(thread.nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    const int standPat = evaluate(position);
+    if (ply >= MAX_PLY - 1 || standPat >= beta)
+        return standPat;
+    alpha = std::max(alpha, standPat);
+
+    MoveList moves;
+    generateLegal(position, moves);
+    orderMoves(thread, moves, NULL_MOVE);
+
+    for (const Move& move : moves) {
+        if (!move.isCapture())
+            continue;
+
+        position.makeMove(move);
+        const int score = -quiesce(thread, -beta, -alpha, ply + 1);
+        position.unmakeMove();
+
+        if (stopped_)
+            return 0;
+
+        if (score > alpha) {
+            alpha = score;
+            updatePv(thread, ply, move);
+            if (alpha >= beta)
+                break;
+        }
+    }
+    return alpha;
+}
+
+void config::Search::orderMoves(const Thread& thread, MoveList& moves, Move tableMove) const
+{
+    const Position& position = thread.position;
+    int scores[MAX_MOVES];
+
+    for (int index = 0; index < moves.size(); ++index) {
+        const Move move = moves[index];
+        Color color;
+        PieceType victim;
+        PieceType attacker;
+
+        if (move == tableMove)
+            scores[index] = TABLE_MOVE_ORDER;
+        else if (move.isCapture() && position.getPieceAt(move.getTo(), color, victim) && position.getPieceAt(move.getFrom(), color, attacker))
+            scores[index] = CAPTURE_ORDER + 8 * PIECE_VALUES[toIndex(victim)] - PIECE_VALUES[toIndex(attacker)];
+        else
+            scores[index] = getQuietOrder(thread.id, move);
+    }
+
+    // insertion sort, the lists are short
+    for (int index = 1; index < moves.size(); ++index) {
+        const Move move = moves[index];
+        const int score = scores[index];
+        int previous = index - 1;
+        for (; previous >= 0 && scores[previous] < score; --previous) {
+            moves[previous + 1] = moves[previous];
+            scores[previous + 1] = scores[previous];
+        }
+        moves[previous + 1] = move;
+        scores[previous + 1] = score;
+    }
+}
+
+void config::Search::updatePv(Thread& thread, int ply, Move move)
+{
+    thread.pv[ply][ply] = move;
+    for (int next = ply + 1; next < thread.pvLength[ply + 1]; ++next)
+        thread.pv[ply][next] = thread.pv[ply + 1][next];
+    thread.pvLength[ply] = std::max(thread.pvLength[ply + 1], ply + 1);
+}
+
+bool config::Search::shouldStop(Thread& thread)
+{
+    if (stopped_.load(std::memory_order_relaxed))
+        return true;
+    if (thread.id != 0)
+        return false;
+
+    const std::uint64_t nodes = thread.nodes.load(std::memory_order_relaxed);
+    if ((nodes & 1023) != 0)
+        return false;
+
+    if ((limits_.nodes && getNodes() >= limits_.nodes)
+        || (limits_.milliseconds && std::chrono::steady_clock::now() - start_ >= std::chrono::milliseconds(limits_.milliseconds)))
+        stopped_ = true;
+
+    return stopped_;
+}
+
+std::uint64_t config::Search::getNodes() const
+{
+    std::uint64_t nodes = 0;
+    for (const auto& thread : threads_)
+        nodes += thread->nodes.load(std::memory_order_relaxed);
+    return nodes;
+}
+
+double config::Search::getElapsedSeconds() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+}
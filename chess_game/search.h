@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "move.h"
+#include "position.h"
+#include "transposition.h"
+
+namespace config {
+    constexpr int MATE_SCORE = 30000;
+    // Scores beyond this bound are mates, counted in plies from the root.
+    constexpr int MATE_BOUND = MATE_SCORE - MAX_PLY;
+    constexpr int INFINITE_SCORE = 32000;
+
+    // A limit left at zero is not applied.
+    struct SearchLimits {
+        int depth = 0;
+        std::uint64_t nodes = 0;
+        int milliseconds = 0;
+    };
+
+    struct SearchResult {
+        Move bestMove = NULL_MOVE;
+        int score = 0;
+        int depth = 0;
+        std::uint64_t nodes = 0;
+        double seconds = 0;
+        std::vector<Move> pv;
+    };
+
+    bool isMateScore(int score);
+    // Moves until mate : positive when the side to move mates, negative when it gets mated.
+    int getMateDistance(int score);
+
+//Negamax alpha-beta search with iterative deepening, scores from the side to move.
+//With several threads (Lazy SMP), helpers search the same root with varied depths and
+//move orders and only communicate through the shared transposition table ; the main
+//thread alone reports results and polls the limits.
+    class Search {
+    public:
+        using IterationCallback = std::function<void(const SearchResult&)>;
+
+        explicit Search(TranspositionTable&, int threads = 1);
+
+        // Calls onIteration after every depth completed by the main thread.
+        SearchResult run(const Position&, const SearchLimits&, const IterationCallback& onIteration = {});
+        void stop();
+        int getThreadCount() const;
+
+    private:
+        struct alignas(64) Thread {
+            int id = 0;
+            Position position;
+            std::atomic<std::uint64_t> nodes{ 0 };
+            Move pv[MAX_PLY][MAX_PLY];
+            int pvLength[MAX_PLY] = {};
+        };
+
+        SearchResult iterate(Thread&, const IterationCallback*);
+        int negamax(Thread&, int depth, int alpha, int beta, int ply);
+        int quiesce(Thread&, int alpha, int beta, int ply);
+        void orderMoves(const Thread&, MoveList&, Move tableMove) const;
+        void updatePv(Thread&, int ply, Move);
+        bool shouldStop(Thread&);
+        std::uint64_t getNodes() const;
+        double getElapsedSeconds() const;
+
+        TranspositionTable& table_;
+        std::vector<std::unique_ptr<Thread>> threads_;
+        SearchLimits limits_;
+        std::chrono::steady_clock::time_point start_;
+        std::atomic<bool> stopped_{ false };
+    };
+}
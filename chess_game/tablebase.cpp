@@ -0,0 +1,697 @@
+#include "tablebase.h"
+#include "attacks.h"
+#include "movegen.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    using namespace config;
+
+    const PieceType NON_KING_TYPES[] = { PieceType::Rook, PieceType::Knight };
+
+    constexpr int KING_PAIR_COUNT = 462;
+    constexpr int MAX_GROUP_SIZE = TB_MAX_PIECES - 2;
+
+    // Rank counted from white's side, so that a1 is (0, 0) and the a1-h8 diagonal is x == rank.
+    constexpr int squareRank(Square square)
+    {
+        return 7 - squareY(square);
+    }
+
+    // The 8 board symmetries : bit 0 mirrors the files, bit 1 the ranks, bit 2 reflects about the a1-h8 diagonal.
+    constexpr Square transformSquare(Square square, int symmetry)
+    {
+        int x = squareX(square);
+        int rank = squareRank(square);
+        if (symmetry & 1)
+            x = 7 - x;
+        if (symmetry & 2)
+            rank = 7 - rank;
+        if (symmetry & 4)
+            std::swap(x, rank);
+        return makeSquare(x, 7 - rank);
+    }
+
+    // Symmetry bringing the square into the a1-d1-d4 triangle.
+    constexpr int getTriangleSymmetry(Square square)
+    {
+        int x = squareX(square);
+        int rank = squareRank(square);
+        int symmetry = 0;
+        if (x > 3) {
+            x = 7 - x;
+            symmetry |= 1;
+        }
+        if (rank > 3) {
+            rank = 7 - rank;
+            symmetry |= 2;
+        }
+        return rank > x ? symmetry | 4 : symmetry;
+    }
+
+    constexpr bool isOnDiagonal(Square square)
+    {
+        return squareX(square) == squareRank(square);
+    }
+
+    // Kings that may stand together, with the white king in the triangle and, when it is on the diagonal,
+    // the black king on or below it. Touching kings are left out : no legal position has them.
+    struct KingPairs {
+        std::array<std::array<std::int16_t, 64>, 64> index{};
+        std::array<std::array<Square, 2>, KING_PAIR_COUNT> squares{};
+        int count = 0;
+    };
+
+    constexpr KingPairs makeKingPairs()
+    {
+        KingPairs pairs{};
+        for (Square white = 0; white < 64; ++white) {
+            for (Square black = 0; black < 64; ++black) {
+                pairs.index[white][black] = -1;
+                const bool inTriangle = getTriangleSymmetry(white) == 0;
+                const bool belowDiagonal = !isOnDiagonal(white) || squareRank(black) <= squareX(black);
+                if (!inTriangle || !belowDiagonal || white == black || (KING_ATTACKS[white] & squareBit(black)))
+                    continue;
+
+                pairs.index[white][black] = static_cast<std::int16_t>(pairs.count);
+                pairs.squares[pairs.count][0] = white;
+                pairs.squares[pairs.count][1] = black;
+                ++pairs.count;
+            }
+        }
+        return pairs;
+    }
+
+    constexpr KingPairs KING_PAIRS = makeKingPairs();
+    static_assert(KING_PAIRS.count == KING_PAIR_COUNT, "462 paires de rois attendues");
+
+    constexpr std::array<std::array<std::uint64_t, MAX_GROUP_SIZE + 1>, 65> makeBinomials()
+    {
+        std::array<std::array<std::uint64_t, MAX_GROUP_SIZE + 1>, 65> binomials{};
+        for (int n = 0; n <= 64; ++n) {
+            binomials[n][0] = 1;
+            for (int k = 1; k <= MAX_GROUP_SIZE; ++k)
+                binomials[n][k] = n == 0 ? 0 : binomials[n - 1][k - 1] + binomials[n - 1][k];
+        }
+        return binomials;
+    }
+
+    // binomial(n, k), for placing k identical pieces
+    constexpr auto BINOMIALS = makeBinomials();
+
+    char getLetter(PieceType type)
+    {
+        return type == PieceType::King ? 'K' : type == PieceType::Rook ? 'R' : 'N';
+    }
+
+    // Value for the side that moves into a position of the given value.
+    TablebaseValue getParentValue(TablebaseValue child)
+    {
+        if (child == TB_UNKNOWN)
+            return TB_UNKNOWN;
+        return isMateValue(child) ? child + 1 : TB_DRAW;
+    }
+}
+
+config::Signature::Signature(const std::string& name)
+{
+    const std::size_t separator = name.find('v');
+    if (separator == std::string::npos)
+        throw std::invalid_argument("Signature de matériel invalide : " + name);
+
+    const std::string sides[NUMBER_OF_COLORS] = { name.substr(separator + 1), name.substr(0, separator) };
+    for (Color color : { Color::White, Color::Black }) {
+        const std::string& side = sides[toIndex(color)];
+        if (side.empty() || side[0] != 'K')
+            throw std::invalid_argument("Signature de matériel invalide, chaque camp commence par son roi : " + name);
+
+        counts_[toIndex(color)][toIndex(PieceType::King)] = 1;
+        for (std::size_t index = 1; index < side.size(); ++index) {
+            if (side[index] == 'R')
+                ++counts_[toIndex(color)][toIndex(PieceType::Rook)];
+            else if (side[index] == 'N')
+                ++counts_[toIndex(color)][toIndex(PieceType::Knight)];
+            else
+                throw std::invalid_argument("Signature de matériel invalide, pièce inconnue : " + name);
+        }
+    }
+    build();
+}
+
+config::Signature config::Signature::fromPosition(const Position& position)
+{
+    Signature signature;
+    for (Color color : { Color::White, Color::Black })
+        for (PieceType type : { PieceType::King, PieceType::Rook, PieceType::Knight })
+            signature.counts_[toIndex(color)][toIndex(type)] = position.getPieceCount(color, type);
+
+    if (signature.counts_[toIndex(Color::White)][toIndex(PieceType::King)] != 1
+        || signature.counts_[toIndex(Color::Black)][toIndex(PieceType::King)] != 1)
+        throw std::invalid_argument("Position sans signature : il faut un roi de chaque couleur");
+    signature.build();
+    return signature;
+}
+
+void config::Signature::build()
+{
+    name_.clear();
+    colors_ = { Color::White, Color::Black };
+    types_ = { PieceType::King, PieceType::King };
+    groups_.clear();
+
+    for (Color color : { Color::White, Color::Black }) {
+        if (color == Color::Black)
+            name_ += 'v';
+        name_ += 'K';
+        for (PieceType type : NON_KING_TYPES) {
+            if (getCount(color, type))
+                groups_.push_back({ static_cast<int>(types_.size()), getCount(color, type) });
+            for (int count = 0; count < getCount(color, type); ++count) {
+                name_ += getLetter(type);
+                colors_.push_back(color);
+                types_.push_back(type);
+            }
+        }
+    }
+
+    if (getPieceCount() > TB_MAX_PIECES)
+        throw std::invalid_argument("Trop de pièces pour une table de finales : " + name_);
+}
+
+const std::string& config::Signature::getName() const
+{
+    return name_;
+}
+
+int config::Signature::getPieceCount() const
+{
+    return static_cast<int>(types_.size());
+}
+
+int config::Signature::getCount(Color color, PieceType type) const
+{
+    return counts_[toIndex(color)][toIndex(type)];
+}
+
+config::Color config::Signature::getColor(int piece) const
+{
+    return colors_[piece];
+}
+
+config::PieceType config::Signature::getType(int piece) const
+{
+    return types_[piece];
+}
+
+bool config::Signature::isInsufficientMaterial() const
+{
+    // Same rule as Position::isInsufficientMaterial : two kings and at most one knight.
+    const int rooks = getCount(Color::White, PieceType::Rook) + getCount(Color::Black, PieceType::Rook);
+    const int knights = getCount(Color::White, PieceType::Knight) + getCount(Color::Black, PieceType::Knight);
+    return rooks == 0 && knights <= 1;
+}
+
+config::MaterialKey config::Signature::getMaterialKey() const
+{
+    MaterialKey key = 0;
+    for (Color color : { Color::White, Color::Black })
+        for (PieceType type : { PieceType::King, PieceType::Rook, PieceType::Knight })
+            key += getCount(color, type) * getMaterialUnit(color, type);
+    return key;
+}
+
+config::Signature config::Signature::without(Color color, PieceType type) const
+{
+    if (type == PieceType::King || getCount(color, type) == 0)
+        throw std::invalid_argument("Aucune pièce à retirer de la signature " + name_);
+
+    Signature signature = *this;
+    --signature.counts_[toIndex(color)][toIndex(type)];
+    signature.build();
+    return signature;
+}
+
+std::uint64_t config::Signature::getIndexCount() const
+{
+    std::uint64_t count = KING_PAIR_COUNT;
+    for (const Group& group : groups_)
+        count *= BINOMIALS[64][group.count];
+    return count;
+}
+
+std::uint64_t config::Signature::encode(const Square* squares) const
+{
+    const int symmetry = getTriangleSymmetry(squares[0]);
+    Square oriented[TB_MAX_PIECES]{};
+    for (int piece = 0; piece < getPieceCount(); ++piece)
+        oriented[piece] = transformSquare(squares[piece], symmetry);
+
+    std::uint64_t index = encodeOriented(oriented);
+
+    // On the diagonal, the reflection about it keeps the white king in the triangle : both are tried.
+    if (isOnDiagonal(oriented[0])) {
+        for (int piece = 0; piece < getPieceCount(); ++piece)
+            oriented[piece] = transformSquare(oriented[piece], 4);
+        index = std::min(index, encodeOriented(oriented));
+    }
+
+    if (index == NO_INDEX)
+        throw std::invalid_argument("Position hors table : les rois se touchent");
+    return index;
+}
+
+std::uint64_t config::Signature::encodeOriented(const Square* squares) const
+{
+    const int kingPair = KING_PAIRS.index[squares[0]][squares[1]];
+    if (kingPair < 0)
+        return NO_INDEX;
+
+    std::uint64_t index = static_cast<std::uint64_t>(kingPair);
+    for (const Group& group : groups_) {
+        // Groups hold a handful of pieces : an insertion sort, which also keeps the accesses inside the array.
+        Square sorted[TB_MAX_PIECES]{};
+        std::copy(squares + group.first, squares + group.first + group.count, sorted);
+        for (int piece = 1; piece < group.count; ++piece)
+            for (int other = piece; other > 0 && sorted[other - 1] > sorted[other]; --other)
+                std::swap(sorted[other - 1], sorted[other]);
+
+        // Combinatorial number system : the k-th smallest square s counts for binomial(s, k).
+        std::uint64_t combination = 0;
+        for (int piece = 0; piece < group.count; ++piece)
+            combination += BINOMIALS[sorted[piece]][piece + 1];
+        index = index * BINOMIALS[64][group.count] + combination;
+    }
+    return index;
+}
+
+std::uint64_t config::Signature::encode(const Position& position) const
+{
+    Bitboard remaining[NUMBER_OF_COLORS][NUMBER_OF_PIECE_TYPES];
+    for (Color color : { Color::White, Color::Black })
+        for (PieceType type : { PieceType::King, PieceType::Rook, PieceType::Knight })
+            remaining[toIndex(color)][toIndex(type)] = position.getPieces(color, type);
+
+    Square squares[TB_MAX_PIECES];
+    for (int piece = 0; piece < getPieceCount(); ++piece)
+        squares[piece] = popLowestSquare(remaining[toIndex(colors_[piece])][toIndex(types_[piece])]);
+    return encode(squares);
+}
+
+bool config::Signature::decode(std::uint64_t index, Square* squares) const
+{
+    const std::uint64_t original = index;
+
+    for (auto group = groups_.rbegin(); group != groups_.rend(); ++group) {
+        std::uint64_t combination = index % BINOMIALS[64][group->count];
+        index /= BINOMIALS[64][group->count];
+
+        Square square = 64;
+        for (int piece = group->count; piece > 0; --piece) {
+            do {
+                --square;
+            } while (BINOMIALS[square][piece] > combination);
+            squares[group->first + piece - 1] = square;
+            combination -= BINOMIALS[square][piece];
+        }
+    }
+    if (index >= KING_PAIR_COUNT)
+        return false;
+    squares[0] = KING_PAIRS.squares[index][0];
+    squares[1] = KING_PAIRS.squares[index][1];
+
+    Bitboard occupancy = EMPTY_BITBOARD;
+    for (int piece = 0; piece < getPieceCount(); ++piece) {
+        if (occupancy & squareBit(squares[piece]))
+            return false;
+        occupancy |= squareBit(squares[piece]);
+    }
+
+    // Positions symmetric to a smaller index are stored there.
+    return encode(squares) == original;
+}
+
+void config::Signature::setup(const Square* squares, Color sideToMove, Position& position) const
+{
+    position.setPieces(getPieceCount(), colors_.data(), types_.data(), squares);
+    position.setSideToMove(sideToMove);
+    position.setCheckState(position.isInCheck(sideToMove));
+}
+
+config::Tablebase::Tablebase(const Signature& signature) :
+    signature_(signature)
+{
+    for (std::vector<TablebaseValue>& values : values_)
+        values.assign(signature_.getIndexCount(), TB_UNKNOWN);
+}
+
+const config::Signature& config::Tablebase::getSignature() const
+{
+    return signature_;
+}
+
+std::uint64_t config::Tablebase::getIndexCount() const
+{
+    return signature_.getIndexCount();
+}
+
+config::TablebaseValue config::Tablebase::getValue(Color sideToMove, std::uint64_t index) const
+{
+    return values_[toIndex(sideToMove)][index];
+}
+
+void config::Tablebase::setValue(Color sideToMove, std::uint64_t index, TablebaseValue value)
+{
+    values_[toIndex(sideToMove)][index] = value;
+}
+
+config::TablebaseValue config::Tablebase::probe(const Position& position) const
+{
+    return getValue(position.getSideToMove(), signature_.encode(position));
+}
+
+//Generation of one table. Level by level in the number of plies to mate : losses at one level give wins
+//one ply later to every position that unmoves into them, and wins give losses to the positions
+//whose moves all lead to decided wins. Captures resolved at start are held back until their level.
+class config::TablebaseGenerator::Work {
+public:
+    Work(const Signature& signature, const TablebaseGenerator& generator) :
+        signature_(signature),
+        threads_(generator.threads_),
+        count_(signature.getIndexCount())
+    {
+        for (Color color : { Color::White, Color::Black }) {
+            for (PieceType type : NON_KING_TYPES) {
+                captures_[toIndex(color)][toIndex(type)] = nullptr;
+                if (signature.getCount(color, type) > 0)
+                    captures_[toIndex(color)][toIndex(type)] = generator.find(signature.without(color, type).getName());
+            }
+            values_[toIndex(color)] = std::make_unique<std::atomic<TablebaseValue>[]>(count_);
+        }
+    }
+
+    std::unique_ptr<Tablebase> run()
+    {
+        forEachRange([this](std::uint64_t begin, std::uint64_t end) { return initialize(begin, end); });
+
+        for (TablebaseValue target = TB_MATED; target < PENDING - 1; ++target) {
+            forEachRange([this, target](std::uint64_t begin, std::uint64_t end) { return applyPending(target, begin, end); });
+            const std::uint64_t decided = forEachRange([this, target](std::uint64_t begin, std::uint64_t end) {
+                return propagate(target, begin, end);
+            });
+            if (!decided && target >= maxPending_.load())
+                break;
+        }
+
+        // Each side is released once copied, so that the table and the work never both hold every entry.
+        auto table = std::make_unique<Tablebase>(signature_);
+        for (Color color : { Color::White, Color::Black }) {
+            for (std::uint64_t index = 0; index < count_; ++index) {
+                const TablebaseValue value = values_[toIndex(color)][index].load(std::memory_order_relaxed);
+                table->setValue(color, index, isUndecided(value) ? TB_DRAW : value);
+            }
+            values_[toIndex(color)].reset();
+        }
+        return table;
+    }
+
+private:
+    using Values = std::unique_ptr<std::atomic<TablebaseValue>[]>;
+
+    // An undecided entry holds the deadline set by a capture or by a loss found too early as PENDING plus
+    // that value, instead of a second array : a shorter mate found in the meantime still replaces it.
+    // Decided values stay below PENDING, far beyond the longest mates of these tables.
+    static constexpr TablebaseValue PENDING = 0x8000;
+
+    static bool isUndecided(TablebaseValue value)
+    {
+        return value == TB_UNKNOWN || (value > PENDING && value < TB_MAX_DECIDED);
+    }
+
+    // Runs fn over consecutive index ranges on every thread and sums what it returns.
+    template <typename Function>
+    std::uint64_t forEachRange(Function fn)
+    {
+        const std::uint64_t chunk = std::max<std::uint64_t>(4096, count_ / (static_cast<std::uint64_t>(threads_) * 64));
+        std::atomic<std::uint64_t> next{ 0 };
+        std::atomic<std::uint64_t> total{ 0 };
+
+        auto work = [&] {
+            std::uint64_t sum = 0;
+            for (std::uint64_t begin = next.fetch_add(chunk); begin < count_; begin = next.fetch_add(chunk))
+                sum += fn(begin, std::min(begin + chunk, count_));
+            total += sum;
+        };
+
+        std::vector<std::thread> helpers;
+        for (int thread = 1; thread < threads_; ++thread)
+            helpers.emplace_back(work);
+        work();
+        for (std::thread& helper : helpers)
+            helper.join();
+        return total.load();
+    }
+
+    std::atomic<TablebaseValue>& getEntry(Color color, std::uint64_t index)
+    {
+        return values_[toIndex(color)][index];
+    }
+
+    // Value of a decided entry, TB_UNKNOWN for an undecided one.
+    TablebaseValue getValue(Color color, std::uint64_t index)
+    {
+        const TablebaseValue value = getEntry(color, index).load(std::memory_order_relaxed);
+        return isUndecided(value) ? TB_UNKNOWN : value;
+    }
+
+    // Stores the value unless another thread decided the entry first.
+    void decide(std::atomic<TablebaseValue>& entry, TablebaseValue value)
+    {
+        TablebaseValue current = entry.load(std::memory_order_relaxed);
+        while (isUndecided(current) && !entry.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    void setPending(Color color, std::uint64_t index, TablebaseValue value)
+    {
+        decide(getEntry(color, index), PENDING + value);
+        TablebaseValue current = maxPending_.load();
+        while (current < value && !maxPending_.compare_exchange_weak(current, value)) {
+        }
+    }
+
+    // Value of the position reached by the move, for the side that is then to move.
+    TablebaseValue getChildValue(Position& position, Move move)
+    {
+        Color color;
+        PieceType type;
+        const bool capture = move.isCapture() && position.getPieceAt(move.getTo(), color, type);
+
+        position.makeMove(move);
+        TablebaseValue value;
+        if (capture) {
+            const Tablebase* table = captures_[toIndex(color)][toIndex(type)];
+            value = table ? table->probe(position) : TB_DRAW;
+        }
+        else {
+            value = getValue(position.getSideToMove(), signature_.encode(position));
+        }
+        position.unmakeMove();
+        return value;
+    }
+
+    // Loss value once every move leads to a decided win for the opponent, unknown otherwise.
+    TablebaseValue getLossValue(Position& position)
+    {
+        MoveList moves;
+        generateLegal(position, moves);
+
+        TablebaseValue worst = TB_UNKNOWN;
+        for (const Move& move : moves) {
+            const TablebaseValue value = getParentValue(getChildValue(position, move));
+            if (getWDL(value) != WDL::Loss)
+                return TB_UNKNOWN;
+            worst = std::max(worst, value);
+        }
+        return worst;
+    }
+
+    // Marks invalid entries, mates and stalemates, and resolves captures into the smaller tables.
+    std::uint64_t initialize(std::uint64_t begin, std::uint64_t end)
+    {
+        Square squares[TB_MAX_PIECES];
+        Position position;
+
+        for (std::uint64_t index = begin; index < end; ++index) {
+            const bool valid = signature_.decode(index, squares);
+
+            for (Color color : { Color::White, Color::Black }) {
+                std::atomic<TablebaseValue>& entry = getEntry(color, index);
+                entry.store(TB_INVALID, std::memory_order_relaxed);
+                if (!valid)
+                    continue;
+
+                signature_.setup(squares, color, position);
+                if (position.isInCheck(opposite(color)))
+                    continue;
+                entry.store(TB_UNKNOWN, std::memory_order_relaxed);
+
+                MoveList moves;
+                generateLegal(position, moves);
+                if (moves.empty()) {
+                    entry.store(position.getCheckState() ? TB_MATED : TB_STALEMATE, std::memory_order_relaxed);
+                    continue;
+                }
+
+                TablebaseValue bestWin = TB_UNKNOWN;
+                TablebaseValue worstLoss = TB_UNKNOWN;
+                bool hasQuiet = false;
+                bool hasDraw = false;
+                for (const Move& move : moves) {
+                    if (!move.isCapture()) {
+                        hasQuiet = true;
+                        continue;
+                    }
+
+                    const TablebaseValue value = getParentValue(getChildValue(position, move));
+                    if (getWDL(value) == WDL::Win)
+                        bestWin = bestWin == TB_UNKNOWN ? value : std::min(bestWin, value);
+                    else if (getWDL(value) == WDL::Loss)
+                        worstLoss = std::max(worstLoss, value);
+                    else
+                        hasDraw = true;
+                }
+
+                // A quieter win may still be shorter, so the capture only sets a deadline.
+                if (bestWin != TB_UNKNOWN)
+                    setPending(color, index, bestWin);
+                else if (!hasQuiet && hasDraw)
+                    entry.store(TB_DRAW, std::memory_order_relaxed);
+                else if (!hasQuiet)
+                    setPending(color, index, worstLoss);
+            }
+        }
+        return 0;
+    }
+
+    std::uint64_t applyPending(TablebaseValue target, std::uint64_t begin, std::uint64_t end)
+    {
+        for (std::uint64_t index = begin; index < end; ++index) {
+            for (Color color : { Color::White, Color::Black }) {
+                std::atomic<TablebaseValue>& entry = getEntry(color, index);
+                if (entry.load(std::memory_order_relaxed) == PENDING + target)
+                    entry.store(target, std::memory_order_relaxed);
+            }
+        }
+        return 0;
+    }
+
+    // Spreads the positions decided at `target` to their predecessors ; returns how many there were.
+    std::uint64_t propagate(TablebaseValue target, std::uint64_t begin, std::uint64_t end)
+    {
+        Square squares[TB_MAX_PIECES];
+        Position position;
+        std::uint64_t decided = 0;
+
+        for (std::uint64_t index = begin; index < end; ++index) {
+            for (Color color : { Color::White, Color::Black }) {
+                if (getEntry(color, index).load(std::memory_order_relaxed) != target)
+                    continue;
+                ++decided;
+
+                signature_.decode(index, squares);
+                signature_.setup(squares, color, position);
+                const Color previousColor = opposite(color);
+
+                MoveList unmoves;
+                generateUnmoves(position, unmoves);
+                for (const Move& unmove : unmoves) {
+                    Square previous[TB_MAX_PIECES];
+                    for (int piece = 0; piece < signature_.getPieceCount(); ++piece)
+                        previous[piece] = squares[piece] == unmove.getFrom() ? unmove.getTo() : squares[piece];
+
+                    std::atomic<TablebaseValue>& entry = getEntry(previousColor, signature_.encode(previous));
+                    if (!isUndecided(entry.load(std::memory_order_relaxed)))
+                        continue;
+
+                    if (getWDL(target) == WDL::Loss) {
+                        decide(entry, target + 1);
+                        continue;
+                    }
+
+                    position.movePiece(unmove.getFrom(), unmove.getTo());
+                    position.setSideToMove(previousColor);
+                    position.setCheckState(position.isInCheck(previousColor));
+
+                    const TablebaseValue loss = getLossValue(position);
+                    if (loss == target + 1)
+                        decide(entry, loss);
+                    else if (loss != TB_UNKNOWN)
+                        setPending(previousColor, signature_.encode(previous), loss);
+
+                    position.movePiece(unmove.getTo(), unmove.getFrom());
+                    position.setSideToMove(color);
+                    position.setCheckState(position.isInCheck(color));
+                }
+            }
+        }
+        return decided;
+    }
+
+    const Signature& signature_;
+    int threads_;
+    std::uint64_t count_;
+    const Tablebase* captures_[NUMBER_OF_COLORS][NUMBER_OF_PIECE_TYPES];
+    Values values_[NUMBER_OF_COLORS];
+    std::atomic<TablebaseValue> maxPending_{ TB_UNKNOWN };
+};
+
+config::TablebaseGenerator::TablebaseGenerator(int threads) :
+    threads_(std::max(1, threads))
+{
+}
+
+const config::Tablebase& config::TablebaseGenerator::generate(const Signature& signature)
+{
+    if (const Tablebase* table = find(signature.getName()))
+        return *table;
+    if (signature.isInsufficientMaterial())
+        throw std::invalid_argument("Matériel insuffisant pour mater : " + signature.getName());
+
+    for (Color color : { Color::White, Color::Black }) {
+        for (PieceType type : NON_KING_TYPES) {
+            if (signature.getCount(color, type) == 0)
+                continue;
+            const Signature smaller = signature.without(color, type);
+            if (!smaller.isInsufficientMaterial())
+                generate(smaller);
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<Tablebase> table = Work(signature, *this).run();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const Tablebase& result = *(tables_[signature.getName()] = std::move(table));
+    if (onTable_)
+        onTable_(result, seconds);
+    return result;
+}
+
+const config::Tablebase* config::TablebaseGenerator::find(const std::string& name) const
+{
+    const auto table = tables_.find(name);
+    return table == tables_.end() ? nullptr : table->second.get();
+}
+
+const std::map<std::string, std::unique_ptr<config::Tablebase>>& config::TablebaseGenerator::getTables() const
+{
+    return tables_;
+}
+
+void config::TablebaseGenerator::setOnTable(std::function<void(const Tablebase&, double)> onTable)
+{
+    onTable_ = std::move(onTable);
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "position.h"
+
+namespace config {
+    // Value of a position for the side to move : ply + 1 once decided, where an even ply count means
+    // the side to move is mated in that many plies and an odd one that it mates in that many plies.
+    using TablebaseValue = std::uint16_t;
+
+    constexpr TablebaseValue TB_UNKNOWN = 0;
+    constexpr TablebaseValue TB_MATED = 1;
+    constexpr TablebaseValue TB_MAX_DECIDED = 0xFFF0;
+    constexpr TablebaseValue TB_DRAW = 0xFFFD;
+    constexpr TablebaseValue TB_STALEMATE = 0xFFFE;
+    constexpr TablebaseValue TB_INVALID = 0xFFFF;
+    constexpr int TB_MAX_PIECES = 7;
+
+    enum class WDL { Loss, Draw, Win };
+
+    // Win or loss with a distance to mate, as opposed to draws, invalid or unknown entries.
+    constexpr bool isMateValue(TablebaseValue value)
+    {
+        return value != TB_UNKNOWN && value < TB_MAX_DECIDED;
+    }
+
+    constexpr int getPliesToMate(TablebaseValue value)
+    {
+        return value - 1;
+    }
+
+    constexpr WDL getWDL(TablebaseValue value)
+    {
+        return !isMateValue(value) ? WDL::Draw : getPliesToMate(value) % 2 ? WDL::Win : WDL::Loss;
+    }
+
+//Material of a pawnless endgame, written like KRRvKNN : the white pieces, 'v', then the black pieces.
+//Pieces are kept in signature order (white king, black king, white rooks, white knights, black rooks,
+//black knights). Without pawns the 8 board symmetries give the same result, so positions are indexed with
+//the white king in the a1-d1-d4 triangle : a pair of non-adjacent kings (462 of them), then each group of
+//identical pieces as a combination of squares.
+    class Signature {
+    public:
+        // Throws std::invalid_argument when the name is not a king followed by rooks and knights, for each side.
+        explicit Signature(const std::string& name);
+        static Signature fromPosition(const Position&);
+
+        const std::string& getName() const;
+        int getPieceCount() const;
+        int getCount(Color, PieceType) const;
+        Color getColor(int piece) const;
+        PieceType getType(int piece) const;
+        bool isInsufficientMaterial() const;
+        // Equal to Position::getMaterialKey() of the positions of the table.
+        MaterialKey getMaterialKey() const;
+        // Material left once a piece of this color and type is captured.
+        Signature without(Color, PieceType) const;
+
+        std::uint64_t getIndexCount() const;
+        // Index of the position or of its mirror image ; throws std::invalid_argument when the kings touch.
+        std::uint64_t encode(const Square* squares) const;
+        std::uint64_t encode(const Position&) const;
+        // False when the index does not describe distinct squares in canonical orientation.
+        bool decode(std::uint64_t index, Square* squares) const;
+        void setup(const Square* squares, Color sideToMove, Position&) const;
+
+    private:
+        // Identical pieces, indexed together
+        struct Group {
+            int first;
+            int count;
+        };
+
+        Signature() = default;
+        void build();
+        // Index of squares already in the triangle, or NO_INDEX when the king pair is not canonical.
+        std::uint64_t encodeOriented(const Square* squares) const;
+
+        static constexpr std::uint64_t NO_INDEX = ~std::uint64_t(0);
+
+        int counts_[NUMBER_OF_COLORS][NUMBER_OF_PIECE_TYPES] = {};
+        std::string name_;
+        std::vector<Color> colors_;
+        std::vector<PieceType> types_;
+        std::vector<Group> groups_;
+    };
+
+//Win/draw/loss and distance to mate of every position of one signature, for both sides to move
+    class Tablebase {
+    public:
+        explicit Tablebase(const Signature&);
+
+        const Signature& getSignature() const;
+        std::uint64_t getIndexCount() const;
+        TablebaseValue getValue(Color sideToMove, std::uint64_t index) const;
+        void setValue(Color sideToMove, std::uint64_t index, TablebaseValue);
+        // The position must hold exactly the pieces of the signature.
+        TablebaseValue probe(const Position&) const;
+
+    private:
+        Signature signature_;
+        std::vector<TablebaseValue> values_[NUMBER_OF_COLORS];
+    };
+
+//Retrograde analysis. Every table reachable by captures is generated first and kept,
+//so that capture moves can be resolved by probing it.
+    class TablebaseGenerator {
+    public:
+        explicit TablebaseGenerator(int threads = 1);
+
+        const Tablebase& generate(const Signature&);
+        const Tablebase* find(const std::string& name) const;
+        const std::map<std::string, std::unique_ptr<Tablebase>>& getTables() const;
+        // Called with each table once it is complete.
+        void setOnTable(std::function<void(const Tablebase&, double seconds)>);
+
+    private:
+        class Work;
+
+        int threads_;
+        std::map<std::string, std::unique_ptr<Tablebase>> tables_;
+        std::function<void(const Tablebase&, double)> onTable_;
+    };
+}
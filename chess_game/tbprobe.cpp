@@ -0,0 +1,376 @@
+#include "tbprobe.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    using namespace config;
+
+    // File layout : magic, signature name (length byte then characters), entries per block, entries and
+    // blocks per side, one offset per block (plus the end) relative to the first block, then the blocks.
+    // Both sides are stored one after the other, black to move first. Integers are little-endian.
+    const char TABLEBASE_MAGIC[4] = { 'C', 'T', 'B', '2' };
+
+    template <typename T>
+    void writeValue(std::vector<unsigned char>& bytes, T value)
+    {
+        for (std::size_t byte = 0; byte < sizeof(T); ++byte)
+            bytes.push_back(static_cast<unsigned char>(value >> (8 * byte)));
+    }
+
+    template <typename T>
+    T readValue(const unsigned char* bytes)
+    {
+        T value = 0;
+        for (std::size_t byte = 0; byte < sizeof(T); ++byte)
+            value |= static_cast<T>(bytes[byte]) << (8 * byte);
+        return value;
+    }
+
+    void writeVarint(std::vector<unsigned char>& bytes, std::uint64_t value)
+    {
+        while (value >= 0x80) {
+            bytes.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<unsigned char>(value));
+    }
+
+    // 7 bits per byte, low bits first ; stops at `end` on a truncated block.
+    std::uint64_t readVarint(const unsigned char*& cursor, const unsigned char* end)
+    {
+        std::uint64_t value = 0;
+        for (int shift = 0; cursor < end && shift < 64; shift += 7) {
+            const unsigned char byte = *cursor++;
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                break;
+        }
+        return value;
+    }
+
+    // Values renumbered so that the frequent ones (draws, short mates) fit in a single byte.
+    std::uint64_t toSymbol(TablebaseValue value)
+    {
+        return value >= TB_DRAW ? value - TB_DRAW : value + 3;
+    }
+
+    TablebaseValue fromSymbol(std::uint64_t symbol)
+    {
+        return static_cast<TablebaseValue>(symbol < 3 ? TB_DRAW + symbol : symbol - 3);
+    }
+
+    // A run is the symbol of its value, shifted left with the low bit set when the run is longer than one
+    // entry, then in that case its length minus two.
+    void writeRun(std::vector<unsigned char>& bytes, TablebaseValue value, std::uint64_t length)
+    {
+        writeVarint(bytes, toSymbol(value) << 1 | (length > 1));
+        if (length > 1)
+            writeVarint(bytes, length - 2);
+    }
+
+    void compressBlock(const Tablebase& table, Color sideToMove, std::uint64_t begin, std::uint64_t end, std::vector<unsigned char>& bytes)
+    {
+        TablebaseValue run = TB_INVALID;
+        std::uint64_t length = 0;
+
+        for (std::uint64_t index = begin; index < end; ++index) {
+            TablebaseValue value = table.getValue(sideToMove, index);
+            if (value == TB_INVALID && length)
+                value = run;
+            if (length && value == run) {
+                ++length;
+                continue;
+            }
+            if (length)
+                writeRun(bytes, run, length);
+            run = value;
+            length = 1;
+        }
+        writeRun(bytes, run, length);
+    }
+
+    void throwInvalid(const std::string& path)
+    {
+        throw std::runtime_error("Fichier de table invalide : " + path);
+    }
+}
+
+void config::writeTablebase(const Tablebase& table, const std::string& path)
+{
+    const std::uint64_t entries = table.getIndexCount();
+    const std::uint64_t blocksPerSide = (entries + TB_BLOCK_ENTRIES - 1) / TB_BLOCK_ENTRIES;
+
+    std::vector<unsigned char> blocks;
+    std::vector<std::uint64_t> offsets;
+    for (Color color : { Color::Black, Color::White }) {
+        for (std::uint64_t begin = 0; begin < entries; begin += TB_BLOCK_ENTRIES) {
+            offsets.push_back(blocks.size());
+            compressBlock(table, color, begin, std::min(begin + TB_BLOCK_ENTRIES, entries), blocks);
+        }
+    }
+    offsets.push_back(blocks.size());
+
+    const std::string& name = table.getSignature().getName();
+    std::vector<unsigned char> header(TABLEBASE_MAGIC, TABLEBASE_MAGIC + sizeof(TABLEBASE_MAGIC));
+    header.push_back(static_cast<unsigned char>(name.size()));
+    header.insert(header.end(), name.begin(), name.end());
+    writeValue(header, TB_BLOCK_ENTRIES);
+    writeValue(header, entries);
+    writeValue(header, blocksPerSide);
+    for (std::uint64_t offset : offsets)
+        writeValue(header, offset);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size());
+    if (!file)
+        throw std::runtime_error("Impossible d'écrire la table " + path);
+}
+
+config::TablebaseFile::TablebaseFile(const std::string& path)
+{
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size)) {
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        throw std::runtime_error("Impossible d'ouvrir la table " + path);
+    }
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    HANDLE mapping = size_ ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    data_ = mapping ? static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    if (mapping)
+        CloseHandle(mapping);
+    CloseHandle(file);
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    struct stat status;
+    if (file < 0 || fstat(file, &status) != 0) {
+        if (file >= 0)
+            close(file);
+        throw std::runtime_error("Impossible d'ouvrir la table " + path);
+    }
+    size_ = static_cast<std::size_t>(status.st_size);
+    void* mapping = size_ ? mmap(nullptr, size_, PROT_READ, MAP_SHARED, file, 0) : MAP_FAILED;
+    data_ = mapping == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(mapping);
+    close(file);
+#endif
+    if (!data_)
+        throw std::runtime_error("Impossible de projeter la table " + path);
+
+    // The destructor does not run when the constructor throws.
+    try {
+        if (size_ < sizeof(TABLEBASE_MAGIC) + 1 || !std::equal(TABLEBASE_MAGIC, TABLEBASE_MAGIC + sizeof(TABLEBASE_MAGIC), data_))
+            throwInvalid(path);
+
+        const std::size_t nameLength = data_[sizeof(TABLEBASE_MAGIC)];
+        const unsigned char* cursor = data_ + sizeof(TABLEBASE_MAGIC) + 1;
+        if (size_ < sizeof(TABLEBASE_MAGIC) + 1 + nameLength + 20)
+            throwInvalid(path);
+
+        try {
+            signature_ = std::make_unique<Signature>(std::string(reinterpret_cast<const char*>(cursor), nameLength));
+        }
+        catch (const std::invalid_argument&) {
+            throwInvalid(path);
+        }
+        cursor += nameLength;
+        const std::uint32_t blockEntries = readValue<std::uint32_t>(cursor);
+        const std::uint64_t entries = readValue<std::uint64_t>(cursor + 4);
+        blocksPerSide_ = readValue<std::uint64_t>(cursor + 12);
+        offsets_ = cursor + 20;
+
+        const std::uint64_t indexSize = (2 * blocksPerSide_ + 1) * sizeof(std::uint64_t);
+        if (blockEntries != TB_BLOCK_ENTRIES || entries != signature_->getIndexCount()
+            || blocksPerSide_ != (entries + TB_BLOCK_ENTRIES - 1) / TB_BLOCK_ENTRIES
+            || static_cast<std::uint64_t>(offsets_ - data_) + indexSize > size_
+            || static_cast<std::uint64_t>(offsets_ - data_) + indexSize + readValue<std::uint64_t>(offsets_ + indexSize - 8) != size_)
+            throwInvalid(path);
+    }
+    catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+config::TablebaseFile::~TablebaseFile()
+{
+    unmap();
+}
+
+void config::TablebaseFile::unmap()
+{
+    if (!data_)
+        return;
+#if defined(_WIN32)
+    UnmapViewOfFile(data_);
+#else
+    munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+    data_ = nullptr;
+}
+
+const config::Signature& config::TablebaseFile::getSignature() const
+{
+    return *signature_;
+}
+
+std::uint64_t config::TablebaseFile::getBlockCount() const
+{
+    return 2 * blocksPerSide_;
+}
+
+std::uint64_t config::TablebaseFile::getBlock(Color sideToMove, std::uint64_t index) const
+{
+    return toIndex(sideToMove) * blocksPerSide_ + index / TB_BLOCK_ENTRIES;
+}
+
+void config::TablebaseFile::decompress(std::uint64_t block, TablebaseValue* values) const
+{
+    const unsigned char* blocks = offsets_ + (2 * blocksPerSide_ + 1) * sizeof(std::uint64_t);
+    const std::uint64_t start = readValue<std::uint64_t>(offsets_ + block * sizeof(std::uint64_t));
+    const std::uint64_t stop = readValue<std::uint64_t>(offsets_ + (block + 1) * sizeof(std::uint64_t));
+
+    // A corrupted index must not send the cursor outside the mapping : the block then holds no value.
+    if (start > stop || stop > static_cast<std::uint64_t>(data_ + size_ - blocks)) {
+        std::fill(values, values + TB_BLOCK_ENTRIES, TB_UNKNOWN);
+        return;
+    }
+    const unsigned char* cursor = blocks + start;
+    const unsigned char* end = blocks + stop;
+
+    std::uint64_t filled = 0;
+    while (cursor < end && filled < TB_BLOCK_ENTRIES) {
+        const std::uint64_t token = readVarint(cursor, end);
+        const TablebaseValue value = fromSymbol(token >> 1);
+        const std::uint64_t length = std::min<std::uint64_t>(token & 1 ? readVarint(cursor, end) + 2 : 1, TB_BLOCK_ENTRIES - filled);
+
+        std::fill(values + filled, values + filled + length, value);
+        filled += length;
+    }
+    std::fill(values + filled, values + TB_BLOCK_ENTRIES, TB_INVALID);
+}
+
+std::size_t config::TablebaseProber::BlockKeyHash::operator()(const BlockKey& key) const
+{
+    return std::hash<const void*>()(key.first) ^ static_cast<std::size_t>(key.second * 0x9E3779B97F4A7C15ULL);
+}
+
+config::TablebaseProber::TablebaseProber(std::size_t cacheMegabytes) :
+    cacheCapacity_(std::max<std::size_t>(1, (cacheMegabytes << 20) / (TB_BLOCK_ENTRIES * sizeof(TablebaseValue))))
+{
+}
+
+int config::TablebaseProber::addDirectory(const std::string& path, std::vector<std::string>* errors)
+{
+    // A missing directory simply holds no table.
+    std::error_code error;
+    int count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(path, error)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".ctb") {
+            // One bad file must not hide the tables that load.
+            try {
+                addFile(entry.path().string());
+                ++count;
+            }
+            catch (const std::runtime_error& failure) {
+                if (errors)
+                    errors->push_back(failure.what());
+            }
+        }
+    }
+    return count;
+}
+
+void config::TablebaseProber::addFile(const std::string& path)
+{
+    auto file = std::make_unique<TablebaseFile>(path);
+    const MaterialKey material = file->getSignature().getMaterialKey();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_[material] = std::move(file);
+    blocks_.clear();
+    cache_.clear();
+}
+
+bool config::TablebaseProber::hasTable(const Position& position) const
+{
+    if (popCount(position.getOccupancy()) > TB_MAX_PIECES)
+        return false;
+    return files_.count(position.getMaterialKey()) > 0;
+}
+
+int config::TablebaseProber::getTableCount() const
+{
+    return static_cast<int>(files_.size());
+}
+
+config::TablebaseValue config::TablebaseProber::probe(const Position& position) const
+{
+    if (popCount(position.getOccupancy()) > TB_MAX_PIECES)
+        return TB_UNKNOWN;
+
+    if (position.isInsufficientMaterial())
+        return TB_DRAW;
+
+    const auto found = files_.find(position.getMaterialKey());
+    if (found == files_.end())
+        return TB_UNKNOWN;
+
+    const TablebaseFile& file = *found->second;
+    const std::uint64_t index = file.getSignature().encode(position);
+    const BlockKey key{ &file, file.getBlock(position.getSideToMove(), index) };
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto cached = cache_.find(key);
+    if (cached != cache_.end()) {
+        blocks_.splice(blocks_.begin(), blocks_, cached->second);
+        return cached->second->values[index % TB_BLOCK_ENTRIES];
+    }
+
+    // The least recently used block is recycled once the cache is full.
+    if (blocks_.size() >= cacheCapacity_) {
+        cache_.erase(blocks_.back().key);
+        blocks_.splice(blocks_.begin(), blocks_, std::prev(blocks_.end()));
+    }
+    else {
+        blocks_.push_front({ key, std::vector<TablebaseValue>(TB_BLOCK_ENTRIES) });
+    }
+
+    CachedBlock& block = blocks_.front();
+    block.key = key;
+    file.decompress(key.second, block.values.data());
+    cache_[key] = blocks_.begin();
+    return block.values[index % TB_BLOCK_ENTRIES];
+}
+
+bool config::TablebaseProber::probeWDL(const Position& position, WDL& wdl) const
+{
+    const TablebaseValue value = probe(position);
+    if (value == TB_UNKNOWN)
+        return false;
+    wdl = getWDL(value);
+    return true;
+}
+
+bool config::TablebaseProber::probeDTM(const Position& position, int& plies) const
+{
+    const TablebaseValue value = probe(position);
+    if (!isMateValue(value))
+        return false;
+    plies = getPliesToMate(value);
+    return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "tablebase.h"
+
+namespace config {
+    // Entries per compressed block, for each side to move.
+    constexpr std::uint32_t TB_BLOCK_ENTRIES = 4096;
+
+    // Writes the table as a header, an index of block offsets and run-length compressed blocks.
+    // Entries of positions that cannot occur are stored as whatever lengthens the current run.
+    void writeTablebase(const Tablebase&, const std::string& path);
+
+//Read-only view of a compressed table file, mapped in memory : blocks are only read when decompressed
+    class TablebaseFile {
+    public:
+        // Throws std::runtime_error when the file is missing or is not a table.
+        explicit TablebaseFile(const std::string& path);
+        TablebaseFile(const TablebaseFile&) = delete;
+        TablebaseFile& operator=(const TablebaseFile&) = delete;
+        ~TablebaseFile();
+
+        const Signature& getSignature() const;
+        std::uint64_t getBlockCount() const;
+        // Block holding an index, counting the blocks of both sides to move.
+        std::uint64_t getBlock(Color sideToMove, std::uint64_t index) const;
+        void decompress(std::uint64_t block, TablebaseValue* values) const;
+
+    private:
+        void unmap();
+
+        const unsigned char* data_ = nullptr;
+        std::size_t size_ = 0;
+        std::unique_ptr<Signature> signature_;
+        std::uint64_t blocksPerSide_ = 0;
+        const unsigned char* offsets_ = nullptr;
+    };
+
+//Tables of a directory, probed through a cache of the most recently decompressed blocks.
+//Probes may come from several threads.
+    class TablebaseProber {
+    public:
+        explicit TablebaseProber(std::size_t cacheMegabytes = 16);
+
+        // Opens every .ctb file of the directory and returns how many tables were loaded.
+        // Files that are not valid tables are skipped, with their error added to `errors` when given.
+        int addDirectory(const std::string& path, std::vector<std::string>* errors = nullptr);
+        void addFile(const std::string& path);
+        bool hasTable(const Position&) const;
+        int getTableCount() const;
+
+        // Value for the side to move, TB_DRAW without enough material to mate, TB_UNKNOWN without a table.
+        TablebaseValue probe(const Position&) const;
+        // False when no table holds the position.
+        bool probeWDL(const Position&, WDL&) const;
+        // Plies to mate, odd when the side to move mates ; false for draws and positions without a table.
+        bool probeDTM(const Position&, int& plies) const;
+
+    private:
+        using BlockKey = std::pair<const TablebaseFile*, std::uint64_t>;
+        struct BlockKeyHash {
+            std::size_t operator()(const BlockKey& key) const;
+        };
+        struct CachedBlock {
+            BlockKey key;
+            std::vector<TablebaseValue> values;
+        };
+
+        // Tables by material, so that a probe finds its table from the position's material key.
+        std::unordered_map<MaterialKey, std::unique_ptr<TablebaseFile>> files_;
+        std::size_t cacheCapacity_;
+        mutable std::mutex mutex_;
+        mutable std::list<CachedBlock> blocks_;
+        mutable std::unordered_map<BlockKey, std::list<CachedBlock>::iterator, BlockKeyHash> cache_;
+    };
+}
@@ -0,0 +1,271 @@
+#include "attacks.h"
+#include "movegen.h"
+#include "perft.h"
+#include "scenarios.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Checks run by ctest, one per argument. Each prints what disagreed and fails with exit code 1.
+namespace {
+    using namespace config;
+
+    constexpr int PERFT_DEPTH = 4;
+    constexpr int TREE_DEPTH = 3;
+
+    // Positions the scenarios reach rarely, written out.
+    const char* const FENS[] = {
+        // Rook pinned on a file, knight pinned, rook pinned on a rank that can take its pinner.
+        "4k3/8/8/8/4r3/8/4R3/4K3 w - - 0 1",
+        "4k3/4r3/8/8/8/8/4N3/4K3 w - - 0 1",
+        "8/8/8/r1R1K3/8/8/8/k7 w - - 0 1",
+        "4k3/4n3/8/8/4R3/8/8/4K3 b - - 0 1",
+        // Two pieces between the rook and the king : neither is pinned.
+        "8/8/8/r1Rn1K2/8/8/8/k7 w - - 0 1",
+        // Checks : the king may not step back along the rook ray, a rook blocks, a knight takes the checker,
+        // a double check, a pinned rook that may not take the checker.
+        "7k/8/8/8/8/8/8/r3K3 w - - 0 1",
+        "4k3/8/8/8/8/8/1R6/r3K3 w - - 0 1",
+        "4k3/8/8/8/8/1N6/8/r3K3 w - - 0 1",
+        "4k3/8/8/8/8/3n4/8/r3K2R w - - 0 1",
+        "4k3/4r3/8/8/8/8/4R1n1/4K3 w - - 0 1",
+    };
+
+    // The five scenarios with either side to move.
+    std::vector<Position> getScenarioPositions()
+    {
+        std::vector<Position> positions;
+        for (const Scenario& scenario : getScenarios())
+            for (Color sideToMove : { Color::White, Color::Black })
+                positions.push_back(getScenarioPosition(scenario, sideToMove));
+        for (const char* fen : FENS) {
+            Position position;
+            position.setFen(fen);
+            positions.push_back(position);
+        }
+        return positions;
+    }
+
+    std::vector<std::uint16_t> getSortedMoves(const MoveList& moves)
+    {
+        std::vector<std::uint16_t> sorted;
+        for (const Move& move : moves)
+            sorted.push_back(move.getData());
+        std::sort(sorted.begin(), sorted.end());
+        return sorted;
+    }
+
+    bool isSameMoves(const MoveList& moves, const MoveList& expected)
+    {
+        return getSortedMoves(moves) == getSortedMoves(expected);
+    }
+
+    // Calls check on every node down to depth plies, stopping at the first one it rejects.
+    template <typename Check>
+    bool walkTree(Position& position, int depth, const Check& check)
+    {
+        if (!check(position))
+            return false;
+        if (depth == 0)
+            return true;
+
+        MoveList moves;
+        generateReference(position, moves);
+        for (const Move& move : moves) {
+            position.makeMove(move);
+            const bool passed = walkTree(position, depth - 1, check);
+            position.unmakeMove();
+            if (!passed)
+                return false;
+        }
+        return true;
+    }
+
+    bool walkTrees(const char* name, bool (*check)(Position&))
+    {
+        bool passed = true;
+        for (Position position : getScenarioPositions()) {
+            if (!walkTree(position, TREE_DEPTH, check)) {
+                std::printf("%s : %s\n", name, position.getFen().c_str());
+                passed = false;
+            }
+        }
+        return passed;
+    }
+
+    // Enemy pieces attacking the king, rook rays walked square by square.
+    Bitboard getReferenceCheckers(const Position& position)
+    {
+        const Color us = position.getSideToMove();
+        const Square king = position.getKingSquare(us);
+        if (king == NO_SQUARE)
+            return EMPTY_BITBOARD;
+
+        Bitboard checkers = EMPTY_BITBOARD;
+        Bitboard pieces = position.getPieces(opposite(us));
+        while (pieces) {
+            const Square square = popLowestSquare(pieces);
+            Color color;
+            PieceType type;
+            position.getPieceAt(square, color, type);
+            const Bitboard attacks = type == PieceType::King ? kingAttacks(square)
+                : type == PieceType::Knight ? knightAttacks(square)
+                : slidingRookAttacks(square, position.getOccupancy());
+            if (attacks & squareBit(king))
+                checkers |= squareBit(square);
+        }
+        return checkers;
+    }
+
+    // Checkers and check state everywhere, and the evasions of every checked node against the reference.
+    bool checkEvasionNode(Position& position)
+    {
+        const Bitboard checkers = getReferenceCheckers(position);
+        if (getCheckers(position) != checkers || position.getCheckState() != (checkers != EMPTY_BITBOARD))
+            return false;
+
+        MoveList expected;
+        generateReference(position, expected);
+        if (hasLegalMove(position) != !expected.empty())
+            return false;
+        if (!checkers)
+            return true;
+
+        MoveList moves;
+        generateEvasions(position, moves);
+        return isSameMoves(moves, expected);
+    }
+
+    // Everything makeMove changes that unmakeMove must give back.
+    struct Snapshot {
+        std::string fen;
+        Key hash;
+        MaterialKey material;
+        bool check;
+        int ply;
+        Bitboard attacked[NUMBER_OF_COLORS];
+
+        explicit Snapshot(const Position& position) :
+            fen(position.getFen()),
+            hash(position.hash()),
+            material(position.getMaterialKey()),
+            check(position.getCheckState()),
+            ply(position.getPly()),
+            attacked{ position.getAttackedSquares(Color::Black), position.getAttackedSquares(Color::White) }
+        {
+        }
+
+        bool operator==(const Snapshot& other) const
+        {
+            return fen == other.fen && hash == other.hash && material == other.material && check == other.check
+                && ply == other.ply && attacked[0] == other.attacked[0] && attacked[1] == other.attacked[1];
+        }
+    };
+
+    // Incremental keys against a recomputation and against the same position set up from scratch,
+    // then every legal move played and taken back.
+    bool checkHashNode(Position& position)
+    {
+        position.verifyHash();
+        position.verifyAttacks();
+
+        Position fresh;
+        fresh.setFen(position.getFen());
+        if (fresh.hash() != position.hash() || fresh.getMaterialKey() != position.getMaterialKey())
+            return false;
+
+        const Snapshot before(position);
+        MoveList moves;
+        generateLegal(position, moves);
+        for (const Move& move : moves) {
+            position.makeMove(move);
+            const bool changed = position.hash() != before.hash && position.hash() == position.computeHash();
+            position.unmakeMove();
+            if (!changed || !(Snapshot(position) == before))
+                return false;
+        }
+        return true;
+    }
+
+    // Legal moves of the whole side and of each piece alone, as the board asks for them, against the reference.
+    bool checkPinnedNode(Position& position)
+    {
+        MoveList expected;
+        generateReference(position, expected);
+        MoveList moves;
+        generateLegal(position, moves);
+        if (!isSameMoves(moves, expected))
+            return false;
+
+        Bitboard pieces = position.getPieces(position.getSideToMove());
+        while (pieces) {
+            const Square square = popLowestSquare(pieces);
+            MoveList pieceMoves;
+            generateLegal(position, pieceMoves, squareBit(square));
+            MoveList pieceExpected;
+            for (const Move& move : expected)
+                if (move.getFrom() == square)
+                    pieceExpected.add(move);
+            if (!isSameMoves(pieceMoves, pieceExpected))
+                return false;
+        }
+        return true;
+    }
+
+    // Leaf counts of the generator, alone, split over threads and through a table, against the reference.
+    bool checkPerft()
+    {
+        bool agree = true;
+        PerftTable table(16);
+        for (Position position : getScenarioPositions()) {
+            const std::uint64_t expected = referencePerft(position, PERFT_DEPTH);
+
+            std::uint64_t split = 0;
+            for (const auto& [move, nodes] : divide(position, PERFT_DEPTH, 2, &table))
+                split += nodes;
+
+            const std::uint64_t nodes = perft(position, PERFT_DEPTH);
+            if (nodes != expected || split != expected) {
+                std::printf("%s : perft %llu, divide %llu, reference %llu\n", position.getFen().c_str(),
+                    static_cast<unsigned long long>(nodes), static_cast<unsigned long long>(split),
+                    static_cast<unsigned long long>(expected));
+                agree = false;
+            }
+        }
+        return agree;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: movegen_test perft|pins|evasions|hash\n");
+        return 1;
+    }
+
+    try {
+        bool passed;
+        if (!std::strcmp(argv[1], "perft"))
+            passed = checkPerft();
+        else if (!std::strcmp(argv[1], "pins"))
+            passed = walkTrees("pins", checkPinnedNode);
+        else if (!std::strcmp(argv[1], "evasions"))
+            passed = walkTrees("evasions", checkEvasionNode);
+        else if (!std::strcmp(argv[1], "hash"))
+            passed = walkTrees("hash", checkHashNode);
+        else {
+            std::fprintf(stderr, "Test inconnu : %s\n", argv[1]);
+            return 1;
+        }
+        std::printf("%s : %s\n", argv[1], passed ? "ok" : "ÉCHEC");
+        return passed ? 0 : 1;
+    }
+    catch (const std::exception& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+}
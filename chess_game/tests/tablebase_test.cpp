@@ -0,0 +1,233 @@
+#include "movegen.h"
+#include "tablebase.h"
+#include "tbprobe.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Tablebase checks run by ctest, one per argument. Each prints what disagreed and fails with exit code 1.
+namespace {
+    using namespace config;
+
+    // Indices decoded per signature ; small tables are walked entirely.
+    constexpr std::uint64_t ENCODING_SAMPLES = 20000;
+
+    const char* const ENCODING_SIGNATURES[] = { "KRvK", "KRvKN", "KNNvK", "KRRvK", "KRvKR" };
+
+    // Plies searched by the minimax of the retrograde check, and positions sampled per side to move
+    // among the mates within that depth and among the other positions.
+    constexpr int RETROGRADE_DEPTH = 5;
+    constexpr std::size_t RETROGRADE_SAMPLES = 40;
+
+    // KNNvK holds draws next to the few forced mates.
+    const char* const RETROGRADE_SIGNATURES[] = { "KRvK", "KNNvK" };
+
+    // One of the 8 board symmetries : bit 0 mirrors the files, bit 1 the ranks, bit 2 swaps files and ranks.
+    Square getMirrorSquare(Square square, int symmetry)
+    {
+        int x = squareX(square);
+        int y = squareY(square);
+        if (symmetry & 1)
+            x = 7 - x;
+        if (symmetry & 2)
+            y = 7 - y;
+        if (symmetry & 4)
+            std::swap(x, y);
+        return makeSquare(x, y);
+    }
+
+    // Every decodable index must come back from its squares, from their 8 mirror images,
+    // and with identical pieces listed in reverse order.
+    bool checkEncoding()
+    {
+        bool agree = true;
+        for (const char* name : ENCODING_SIGNATURES) {
+            const Signature signature(name);
+            const int pieces = signature.getPieceCount();
+            const std::uint64_t step = signature.getIndexCount() / ENCODING_SAMPLES + 1;
+            std::uint64_t decoded = 0;
+            for (std::uint64_t index = 0; index < signature.getIndexCount(); index += step) {
+                Square squares[TB_MAX_PIECES];
+                if (!signature.decode(index, squares))
+                    continue;
+                ++decoded;
+
+                Square reversed[TB_MAX_PIECES];
+                std::copy(squares, squares + pieces, reversed);
+                for (int first = 0; first < pieces;) {
+                    int last = first + 1;
+                    while (last < pieces && signature.getColor(last) == signature.getColor(first)
+                        && signature.getType(last) == signature.getType(first))
+                        ++last;
+                    std::reverse(reversed + first, reversed + last);
+                    first = last;
+                }
+                if (signature.encode(reversed) != index) {
+                    std::printf("%s : index %llu, pièces identiques permutées -> %llu\n", name,
+                        static_cast<unsigned long long>(index),
+                        static_cast<unsigned long long>(signature.encode(reversed)));
+                    agree = false;
+                }
+
+                for (int symmetry = 0; symmetry < 8; ++symmetry) {
+                    Square mirrored[TB_MAX_PIECES];
+                    for (int piece = 0; piece < pieces; ++piece)
+                        mirrored[piece] = getMirrorSquare(squares[piece], symmetry);
+                    const std::uint64_t encoded = signature.encode(mirrored);
+                    if (encoded != index) {
+                        std::printf("%s : index %llu, symétrie %d -> %llu\n", name,
+                            static_cast<unsigned long long>(index), symmetry,
+                            static_cast<unsigned long long>(encoded));
+                        agree = false;
+                    }
+                }
+            }
+            if (!decoded) {
+                std::printf("%s : aucun index décodé\n", name);
+                agree = false;
+            }
+        }
+        return agree;
+    }
+
+    // A generated table written with writeTablebase and read back through the prober
+    // must give the same value for every valid position.
+    bool checkFile()
+    {
+        TablebaseGenerator generator;
+        const Tablebase& table = generator.generate(Signature("KRvK"));
+        const Signature& signature = table.getSignature();
+
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "tablebase_test_KRvK.ctb";
+        writeTablebase(table, path.string());
+
+        bool agree = true;
+        {
+            TablebaseProber prober;
+            prober.addFile(path.string());
+            for (std::uint64_t index = 0; index < table.getIndexCount(); ++index) {
+                Square squares[TB_MAX_PIECES];
+                if (!signature.decode(index, squares))
+                    continue;
+                for (Color color : { Color::White, Color::Black }) {
+                    const TablebaseValue expected = table.getValue(color, index);
+                    if (expected == TB_INVALID)
+                        continue;
+                    Position position;
+                    signature.setup(squares, color, position);
+                    const TablebaseValue probed = prober.probe(position);
+                    if (probed != expected) {
+                        std::printf("%s : table %u, fichier %u\n", position.getFen().c_str(), expected, probed);
+                        agree = false;
+                    }
+                }
+            }
+        }
+        std::filesystem::remove(path);
+        return agree;
+    }
+
+    // Value of the position when the game ends within `depth` plies, with the tablebase convention,
+    // TB_UNKNOWN otherwise. Positions left without mating material count as undecided.
+    TablebaseValue searchMate(Position& position, int depth)
+    {
+        MoveList moves;
+        generateLegal(position, moves);
+        if (moves.empty())
+            return position.getCheckState() ? TB_MATED : TB_STALEMATE;
+        if (depth == 0 || position.isInsufficientMaterial())
+            return TB_UNKNOWN;
+
+        // The shortest win, or else the longest loss when every move loses.
+        TablebaseValue win = TB_UNKNOWN;
+        TablebaseValue loss = TB_MATED;
+        for (const Move& move : moves) {
+            position.makeMove(move);
+            const TablebaseValue value = searchMate(position, depth - 1);
+            position.unmakeMove();
+            if (!isMateValue(value))
+                loss = TB_UNKNOWN;
+            else if (getWDL(value) == WDL::Loss)
+                win = win == TB_UNKNOWN ? value + 1 : std::min<TablebaseValue>(win, value + 1);
+            else if (loss != TB_UNKNOWN)
+                loss = std::max<TablebaseValue>(loss, value + 1);
+        }
+        return win != TB_UNKNOWN ? win : loss;
+    }
+
+    // Sampled positions of small generated tables searched by plain minimax : mates within the depth
+    // must come out with the same distance, and no other position may show a mate that short.
+    bool checkRetrograde()
+    {
+        TablebaseGenerator generator;
+        bool agree = true;
+        for (const char* name : RETROGRADE_SIGNATURES) {
+            const Tablebase& table = generator.generate(Signature(name));
+            const Signature& signature = table.getSignature();
+            for (Color color : { Color::White, Color::Black }) {
+                std::vector<std::uint64_t> samples[2];
+                for (std::uint64_t index = 0; index < table.getIndexCount(); ++index) {
+                    Square squares[TB_MAX_PIECES];
+                    const TablebaseValue value = table.getValue(color, index);
+                    if (value != TB_INVALID && signature.decode(index, squares))
+                        samples[isMateValue(value) && getPliesToMate(value) <= RETROGRADE_DEPTH].push_back(index);
+                }
+
+                for (const std::vector<std::uint64_t>& indices : samples) {
+                    const std::size_t step = indices.size() / RETROGRADE_SAMPLES + 1;
+                    for (std::size_t sample = 0; sample < indices.size(); sample += step) {
+                        Square squares[TB_MAX_PIECES];
+                        signature.decode(indices[sample], squares);
+                        Position position;
+                        signature.setup(squares, color, position);
+
+                        TablebaseValue expected = table.getValue(color, indices[sample]);
+                        if (expected == TB_DRAW || (isMateValue(expected) && getPliesToMate(expected) > RETROGRADE_DEPTH))
+                            expected = TB_UNKNOWN;
+                        const TablebaseValue found = searchMate(position, RETROGRADE_DEPTH);
+                        if (found != expected) {
+                            std::printf("%s : table %u, minimax %u\n", position.getFen().c_str(),
+                                table.getValue(color, indices[sample]), found);
+                            agree = false;
+                        }
+                    }
+                }
+            }
+        }
+        return agree;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: tablebase_test encoding|file|retrograde\n");
+        return 1;
+    }
+
+    try {
+        bool passed;
+        if (!std::strcmp(argv[1], "encoding"))
+            passed = checkEncoding();
+        else if (!std::strcmp(argv[1], "file"))
+            passed = checkFile();
+        else if (!std::strcmp(argv[1], "retrograde"))
+            passed = checkRetrograde();
+        else {
+            std::fprintf(stderr, "Test inconnu : %s\n", argv[1]);
+            return 1;
+        }
+        std::printf("%s : %s\n", argv[1], passed ? "ok" : "ÉCHEC");
+        return passed ? 0 : 1;
+    }
+    catch (const std::exception& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+}
@@ -1,43 +1,31 @@
 #include "structure.h"
 
-config::Tile::Tile(const std::string& name, bool isOccupied) :
-    name_(name), isOccupied_(isOccupied), occupyingPiece_(nullptr)
+config::Tile::Tile() :
+    board_(nullptr), square_(NO_SQUARE)
 {
 }
 
-void config::Tile::setOccupyingPiece(std::unique_ptr<Piece> newPiece)
+config::Tile::Tile(const Board* board, Square square) :
+    board_(board), square_(square)
 {
-    occupyingPiece_ = std::move(newPiece);
-    isOccupied_ = true;
 }
 
-void config::Tile::destroyOccupyingPiece()
-{
-    occupyingPiece_.reset();
-    isOccupied_ = false;
-}
-
-std::unique_ptr<config::Piece> config::Tile::changePossessingPiece()
-{
-    return std::move(occupyingPiece_);
-}
-
-void config::Tile::reverseOccupation()
+std::string config::Tile::getTileName() const
 {
-    isOccupied_ = !isOccupied_;
+    return board_->getTileName(square_);
 }
 
-std::string config::Tile::getTileName() const
+const config::Piece* config::Tile::getOccupyingPiece() const
 {
-    return name_;
+    return board_->getPieceAt(square_);
 }
 
-config::Piece* config::Tile::getOccupyingPiece() const
+bool config::Tile::getIsOccupied() const
 {
-    return occupyingPiece_.get();
+    return board_->getPosition().isOccupied(square_);
 }
 
-bool config::Tile::getIsOccupied() const
+config::Square config::Tile::getSquare() const
 {
-    return isOccupied_;
+    return square_;
 }
@@ -0,0 +1,87 @@
+#include "scenarios.h"
+#include "search.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+    using namespace config;
+
+    int printUsage()
+    {
+        std::fprintf(stderr, "usage: analyze [--depth N] [--nodes N] [--time ms] [--hash MB] [--threads N]\n");
+        return 1;
+    }
+
+    std::string formatMove(const Board& board, Move move)
+    {
+        return board.getTileName(move.getFrom()) + "-" + board.getTileName(move.getTo());
+    }
+
+    std::string formatScore(int score)
+    {
+        if (isMateScore(score))
+            return "mate " + std::to_string(getMateDistance(score));
+        return "cp " + std::to_string(score);
+    }
+
+    void analyzeScenario(const Scenario& scenario, Color sideToMove, const SearchLimits& limits, TranspositionTable& table, int threads)
+    {
+        Board board(sideToMove);
+        board.reset();
+        board.create(scenario.positions, scenario.pieces);
+        board.setTurn(sideToMove);
+
+        std::printf("%s, %s to move\n", scenario.name, sideToMove == Color::White ? "white" : "black");
+
+        table.clear();
+        Search search(table, threads);
+        const SearchResult result = search.run(board.getPosition(), limits, [&](const SearchResult& iteration) {
+            std::string pv;
+            for (Move move : iteration.pv)
+                pv += " " + formatMove(board, move);
+            std::printf("  depth %2d  %-9s  nodes %10llu  %6.2fs  pv%s\n", iteration.depth, formatScore(iteration.score).c_str(),
+                static_cast<unsigned long long>(iteration.nodes), iteration.seconds, pv.c_str());
+        });
+
+        std::printf("  best %s  %s  %.0f nodes/s\n\n", result.bestMove.isNull() ? "none" : formatMove(board, result.bestMove).c_str(),
+            formatScore(result.score).c_str(), result.seconds > 0 ? result.nodes / result.seconds : 0.0);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    SearchLimits limits;
+    std::size_t hashMegabytes = 64;
+    int threads = 1;
+
+    // Every flag takes a value : a trailing one without it is a bad argument, not an ignored one.
+    if (argc % 2 == 0)
+        return printUsage();
+    for (int index = 1; index + 1 < argc; index += 2) {
+        if (!std::strcmp(argv[index], "--depth"))
+            limits.depth = std::atoi(argv[index + 1]);
+        else if (!std::strcmp(argv[index], "--nodes"))
+            limits.nodes = std::strtoull(argv[index + 1], nullptr, 10);
+        else if (!std::strcmp(argv[index], "--time"))
+            limits.milliseconds = std::atoi(argv[index + 1]);
+        else if (!std::strcmp(argv[index], "--threads"))
+            threads = std::atoi(argv[index + 1]);
+        else if (!std::strcmp(argv[index], "--hash"))
+            hashMegabytes = std::strtoull(argv[index + 1], nullptr, 10);
+        else
+            return printUsage();
+    }
+    // The search and the table reject these with an exception : report them as bad arguments instead.
+    if (threads < 1 || hashMegabytes == 0)
+        return printUsage();
+    if (!limits.depth && !limits.nodes && !limits.milliseconds)
+        limits.milliseconds = 2000;
+
+    TranspositionTable table(hashMegabytes);
+    for (const Scenario& scenario : getScenarios())
+        for (Color sideToMove : { Color::White, Color::Black })
+            analyzeScenario(scenario, sideToMove, limits, table, threads);
+    return 0;
+}
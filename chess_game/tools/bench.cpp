@@ -0,0 +1,123 @@
+#include "attacks.h"
+#include "scenarios.h"
+#include "search.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    using namespace config;
+
+    struct Sample {
+        Square square;
+        Bitboard occupancy;
+    };
+
+    std::vector<Sample> makeSamples(std::size_t count)
+    {
+        std::mt19937_64 random(2024);
+        std::vector<Sample> samples(count);
+
+        for (auto& sample : samples) {
+            sample.square = static_cast<Square>(random() % 64);
+            // sparse occupancies, as in the endgames the engine plays
+            sample.occupancy = random() & random() & random();
+        }
+        return samples;
+    }
+
+    template <typename Attacks>
+    void benchBackend(const char* name, const std::vector<Sample>& samples, int rounds, Attacks attacks)
+    {
+        Bitboard checksum = EMPTY_BITBOARD;
+        std::size_t mismatches = 0;
+
+        for (const auto& sample : samples)
+            if (attacks(sample.square, sample.occupancy) != slidingRookAttacks(sample.square, sample.occupancy))
+                ++mismatches;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round)
+            for (const auto& sample : samples)
+                checksum ^= attacks(sample.square, sample.occupancy ^ checksum);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const double calls = static_cast<double>(samples.size()) * rounds;
+        std::printf("%-8s %12.0f attacks/s  (%zu mismatches, checksum %016llx)\n",
+            name, calls / elapsed.count(), mismatches, static_cast<unsigned long long>(checksum));
+    }
+
+    void benchRookAttacks(int rounds)
+    {
+        const std::vector<Sample> samples = makeSamples(1 << 16);
+
+        std::printf("Rook attacks, %d x %zu lookups, startup backend: %s\n", rounds, samples.size(),
+            getRookBackend() == RookBackend::Pext ? "pext" : "magic");
+
+        benchBackend("sliding", samples, rounds / 16 + 1, slidingRookAttacks);
+        benchBackend("magic", samples, rounds, rookAttacksMagic);
+        if (isPextSupported())
+            benchBackend("pext", samples, rounds, rookAttacksPext);
+        else
+            std::printf("pext     not supported on this CPU\n");
+    }
+
+    // Runs the whole benchmark set (every scenario, both sides to move) for 1, 2, 4 ... threads.
+    void benchSearch(int maxThreads, int milliseconds)
+    {
+        std::vector<Position> positions;
+        for (const Scenario& scenario : getScenarios()) {
+            for (Color sideToMove : { Color::White, Color::Black }) {
+                Board board(sideToMove);
+                board.create(scenario.positions, scenario.pieces);
+                board.setTurn(sideToMove);
+                positions.push_back(board.getPosition());
+            }
+        }
+
+        std::printf("Search, %zu positions, %d ms each\n", positions.size(), milliseconds);
+
+        TranspositionTable table(256);
+        double singleThreadSpeed = 0;
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            Search search(table, threads);
+            SearchLimits limits;
+            limits.milliseconds = milliseconds;
+
+            std::uint64_t nodes = 0;
+            double seconds = 0;
+            for (const Position& position : positions) {
+                table.clear();
+                const SearchResult result = search.run(position, limits);
+                nodes += result.nodes;
+                seconds += result.seconds;
+            }
+
+            const double speed = nodes / seconds;
+            if (threads == 1)
+                singleThreadSpeed = speed;
+            std::printf("%2d threads %12.0f nodes/s  (x%.2f)\n", threads, speed, speed / singleThreadSpeed);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::string mode = argc > 1 ? argv[1] : "rook";
+
+    if (mode == "rook") {
+        benchRookAttacks(argc > 2 ? std::atoi(argv[2]) : 200);
+        return 0;
+    }
+
+    if (mode == "search") {
+        benchSearch(argc > 2 ? std::atoi(argv[2]) : 16, argc > 3 ? std::atoi(argv[3]) : 1000);
+        return 0;
+    }
+
+    std::fprintf(stderr, "usage: bench [rook [rounds] | search [threads] [milliseconds]]\n");
+    return 1;
+}
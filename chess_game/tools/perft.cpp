@@ -0,0 +1,142 @@
+#include "perft.h"
+#include "scenarios.h"
+#include "structure.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    using namespace config;
+
+    struct Options {
+        int depth = 4;
+        bool divide = false;
+        bool compare = false;
+        int threads = 1;
+        std::size_t hashMegabytes = 0;
+    };
+
+    int printUsage()
+    {
+        std::fprintf(stderr, "usage: perft [--depth N] [--fen FEN | --scenario 1-5 [--black]] [--divide] [--compare]\n"
+            "             [--threads N] [--hash MB]\n");
+        return 1;
+    }
+
+    double getSeconds(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Returns false when the generator and reference counts disagree.
+    bool runPerft(const std::string& name, Position position, const Options& options, PerftTable* table)
+    {
+        bool agree = true;
+
+        std::printf("%s\n  %s\n", name.c_str(), position.getFen().c_str());
+
+        for (int depth = 1; depth <= options.depth; ++depth) {
+            const auto start = std::chrono::steady_clock::now();
+            std::uint64_t nodes = 0;
+            if (options.threads > 1 || table) {
+                for (const auto& [move, count] : divide(position, depth, options.threads, table))
+                    nodes += count;
+            }
+            else {
+                nodes = perft(position, depth);
+            }
+            const double seconds = getSeconds(start);
+
+            std::printf("  depth %2d %14llu nodes %8.3fs %12.0f nodes/s", depth,
+                static_cast<unsigned long long>(nodes), seconds, seconds > 0 ? nodes / seconds : 0.0);
+
+            if (options.compare) {
+                const auto referenceStart = std::chrono::steady_clock::now();
+                const std::uint64_t referenceNodes = referencePerft(position, depth);
+                const double referenceSeconds = getSeconds(referenceStart);
+
+                std::printf("  | reference %14llu nodes %12.0f nodes/s%s", static_cast<unsigned long long>(referenceNodes),
+                    referenceSeconds > 0 ? referenceNodes / referenceSeconds : 0.0, referenceNodes == nodes ? "" : "  MISMATCH");
+                agree = agree && referenceNodes == nodes;
+            }
+            std::printf("\n");
+        }
+
+        if (options.divide) {
+            std::uint64_t total = 0;
+            for (const auto& [move, nodes] : divide(position, options.depth, options.threads, table)) {
+                std::printf("  %s-%s: %llu\n", TILE_NAMES[move.getFrom()], TILE_NAMES[move.getTo()],
+                    static_cast<unsigned long long>(nodes));
+                total += nodes;
+            }
+            std::printf("  total: %llu\n", static_cast<unsigned long long>(total));
+        }
+        std::printf("\n");
+        return agree;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    std::string fen;
+    int scenarioIndex = 0;
+    Color sideToMove = Color::White;
+
+    for (int index = 1; index < argc; ++index) {
+        const bool hasValue = index + 1 < argc;
+        if (!std::strcmp(argv[index], "--depth") && hasValue)
+            options.depth = std::atoi(argv[++index]);
+        else if (!std::strcmp(argv[index], "--fen") && hasValue)
+            fen = argv[++index];
+        else if (!std::strcmp(argv[index], "--scenario") && hasValue) {
+            scenarioIndex = std::atoi(argv[++index]);
+            if (scenarioIndex < 1 || scenarioIndex > static_cast<int>(getScenarios().size()))
+                return printUsage();
+        }
+        else if (!std::strcmp(argv[index], "--black"))
+            sideToMove = Color::Black;
+        else if (!std::strcmp(argv[index], "--threads") && hasValue)
+            options.threads = std::max(1, std::atoi(argv[++index]));
+        else if (!std::strcmp(argv[index], "--hash") && hasValue)
+            options.hashMegabytes = std::strtoull(argv[++index], nullptr, 10);
+        else if (!std::strcmp(argv[index], "--divide"))
+            options.divide = true;
+        else if (!std::strcmp(argv[index], "--compare"))
+            options.compare = true;
+        else
+            return printUsage();
+    }
+
+    try {
+        bool agree = true;
+        std::unique_ptr<PerftTable> table;
+        if (options.hashMegabytes)
+            table = std::make_unique<PerftTable>(options.hashMegabytes);
+
+        if (!fen.empty()) {
+            Position position;
+            position.setFen(fen);
+            agree = runPerft("FEN", position, options, table.get());
+        }
+        else {
+            const auto& scenarios = getScenarios();
+            for (int index = 0; index < static_cast<int>(scenarios.size()); ++index) {
+                if (scenarioIndex && scenarioIndex != index + 1)
+                    continue;
+
+                agree = runPerft(scenarios[index].name, getScenarioPosition(scenarios[index], sideToMove), options, table.get()) && agree;
+            }
+        }
+        return agree ? 0 : 2;
+    }
+    catch (const std::invalid_argument& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+}
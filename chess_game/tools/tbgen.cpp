@@ -0,0 +1,98 @@
+#include "tablebase.h"
+#include "tbprobe.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using namespace config;
+
+    // Win/draw/loss counts and longest mate, for the given side to move.
+    void printSummary(const Tablebase& table, Color sideToMove)
+    {
+        std::uint64_t counts[3] = {};
+        TablebaseValue longest = TB_UNKNOWN;
+        std::uint64_t longestIndex = 0;
+
+        for (std::uint64_t index = 0; index < table.getIndexCount(); ++index) {
+            const TablebaseValue value = table.getValue(sideToMove, index);
+            if (value == TB_INVALID)
+                continue;
+            ++counts[static_cast<int>(getWDL(value))];
+            if (isMateValue(value) && value > longest) {
+                longest = value;
+                longestIndex = index;
+            }
+        }
+
+        std::printf("  %s to move: %llu wins, %llu draws, %llu losses", sideToMove == Color::White ? "white" : "black",
+            static_cast<unsigned long long>(counts[static_cast<int>(WDL::Win)]),
+            static_cast<unsigned long long>(counts[static_cast<int>(WDL::Draw)]),
+            static_cast<unsigned long long>(counts[static_cast<int>(WDL::Loss)]));
+
+        if (longest != TB_UNKNOWN) {
+            Square squares[TB_MAX_PIECES];
+            Position position;
+            table.getSignature().decode(longestIndex, squares);
+            table.getSignature().setup(squares, sideToMove, position);
+            std::printf(", longest mate %d plies (%s)", getPliesToMate(longest), position.getFen().c_str());
+        }
+        std::printf("\n");
+    }
+
+    int printUsage()
+    {
+        std::fprintf(stderr, "usage: tbgen SIGNATURE... [--threads N] [--out DIR]\n"
+            "       e.g. tbgen KRvK KRvKN ; every table reached by captures is generated too\n");
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> names;
+    std::string directory = ".";
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int index = 1; index < argc; ++index) {
+        const bool hasValue = index + 1 < argc;
+        if (!std::strcmp(argv[index], "--threads") && hasValue)
+            threads = std::max(1, std::atoi(argv[++index]));
+        else if (!std::strcmp(argv[index], "--out") && hasValue)
+            directory = argv[++index];
+        else if (argv[index][0] != '-')
+            names.push_back(argv[index]);
+        else
+            return printUsage();
+    }
+    if (names.empty())
+        return printUsage();
+
+    try {
+        TablebaseGenerator generator(threads);
+        generator.setOnTable([&](const Tablebase& table, double seconds) {
+            const std::string path = directory + "/" + table.getSignature().getName() + ".ctb";
+            writeTablebase(table, path);
+            std::printf("%s: %llu entries per side in %.2fs -> %s (%llu KB)\n", table.getSignature().getName().c_str(),
+                static_cast<unsigned long long>(table.getIndexCount()), seconds, path.c_str(),
+                static_cast<unsigned long long>(std::filesystem::file_size(path) >> 10));
+            printSummary(table, Color::White);
+            printSummary(table, Color::Black);
+            std::fflush(stdout);
+        });
+
+        for (const std::string& name : names)
+            generator.generate(Signature(name));
+        return 0;
+    }
+    catch (const std::exception& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+}
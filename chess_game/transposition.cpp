@@ -0,0 +1,145 @@
+#include "transposition.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    // data layout : move (bits 0-15), score (16-31), depth (32-39), bound (40-41), age (42-47)
+    constexpr unsigned AGE_BITS = 6;
+    constexpr unsigned AGE_MASK = (1u << AGE_BITS) - 1;
+}
+
+config::TranspositionTable::TranspositionTable(std::size_t megabytes)
+{
+    resize(megabytes);
+}
+
+void config::TranspositionTable::resize(std::size_t megabytes)
+{
+    if (megabytes == 0)
+        throw std::invalid_argument("La table de transposition doit faire au moins 1 Mo");
+
+    const std::size_t bytes = megabytes << 20;
+    std::size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= bytes)
+        count *= 2;
+
+    buckets_ = std::make_unique<Bucket[]>(count);
+    mask_ = count - 1;
+    clear();
+}
+
+void config::TranspositionTable::clear()
+{
+    for (std::size_t index = 0; index <= mask_; ++index) {
+        for (Entry& entry : buckets_[index].entries) {
+            entry.key.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    age_ = 0;
+}
+
+void config::TranspositionTable::newSearch()
+{
+    age_ = (age_ + 1) & AGE_MASK;
+}
+
+bool config::TranspositionTable::probe(Key key, TTData& data) const
+{
+    for (const Entry& entry : getBucket(key).entries) {
+        const std::uint64_t packed = entry.data.load(std::memory_order_relaxed);
+        if ((entry.key.load(std::memory_order_relaxed) ^ packed) == key && packed != 0) {
+            data = unpack(packed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void config::TranspositionTable::store(Key key, const TTData& data)
+{
+    Bucket& bucket = getBucket(key);
+    Entry* replaced = &bucket.entries[0];
+    int lowestValue = std::numeric_limits<int>::max();
+
+    for (Entry& entry : bucket.entries) {
+        const std::uint64_t packed = entry.data.load(std::memory_order_relaxed);
+        if (packed == 0 || (entry.key.load(std::memory_order_relaxed) ^ packed) == key) {
+            replaced = &entry;
+            break;
+        }
+
+        // Prefer overwriting entries from old searches, then the shallowest ones.
+        const int ageDistance = static_cast<int>((age_ - getAge(packed)) & AGE_MASK);
+        const int value = getDepth(packed) - 8 * ageDistance;
+        if (value < lowestValue) {
+            lowestValue = value;
+            replaced = &entry;
+        }
+    }
+
+    TTData stored = data;
+    const std::uint64_t previous = replaced->data.load(std::memory_order_relaxed);
+    if (stored.move.isNull() && (replaced->key.load(std::memory_order_relaxed) ^ previous) == key)
+        stored.move = unpack(previous).move;
+
+    const std::uint64_t packed = pack(stored, age_);
+    replaced->key.store(key ^ packed, std::memory_order_relaxed);
+    replaced->data.store(packed, std::memory_order_relaxed);
+}
+
+std::size_t config::TranspositionTable::getBucketCount() const
+{
+    return mask_ + 1;
+}
+
+int config::TranspositionTable::getUsage() const
+{
+    const std::size_t sampled = std::min<std::size_t>(250, mask_ + 1);
+    int used = 0;
+
+    for (std::size_t index = 0; index < sampled; ++index)
+        for (const Entry& entry : buckets_[index].entries) {
+            const std::uint64_t packed = entry.data.load(std::memory_order_relaxed);
+            if (packed != 0 && getAge(packed) == age_)
+                ++used;
+        }
+    return static_cast<int>(used * 1000 / (sampled * 4));
+}
+
+std::uint64_t config::TranspositionTable::pack(const TTData& data, unsigned age)
+{
+    const int depth = std::clamp(data.depth, 0, 255);
+
+    return static_cast<std::uint64_t>(data.move.getData())
+        | static_cast<std::uint64_t>(static_cast<std::uint16_t>(data.score)) << 16
+        | static_cast<std::uint64_t>(depth) << 32
+        | static_cast<std::uint64_t>(data.bound) << 40
+        | static_cast<std::uint64_t>(age & AGE_MASK) << 42;
+}
+
+config::TTData config::TranspositionTable::unpack(std::uint64_t data)
+{
+    TTData result;
+    result.move = Move::fromData(static_cast<std::uint16_t>(data));
+    result.score = static_cast<std::int16_t>(data >> 16);
+    result.depth = getDepth(data);
+    result.bound = static_cast<Bound>((data >> 40) & 3);
+    return result;
+}
+
+unsigned config::TranspositionTable::getAge(std::uint64_t data)
+{
+    return static_cast<unsigned>(data >> 42) & AGE_MASK;
+}
+
+int config::TranspositionTable::getDepth(std::uint64_t data)
+{
+    return static_cast<int>((data >> 32) & 0xFF);
+}
+
+config::TranspositionTable::Bucket& config::TranspositionTable::getBucket(Key key) const
+{
+    return buckets_[key & mask_];
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "move.h"
+#include "zobrist.h"
+
+namespace config {
+    // How the stored score relates to the true score of the position.
+    enum class Bound : std::uint8_t { None, Exact, Lower, Upper };
+
+    struct TTData {
+        Move move;
+        int score;
+        int depth;
+        Bound bound;
+    };
+
+//Shared transposition table : power-of-two number of 64-byte buckets of four entries.
+//Each entry is two atomic words, the key stored XORed with the data, so that a torn
+//write by another thread fails the key check instead of returning mixed data.
+    class TranspositionTable {
+    public:
+        explicit TranspositionTable(std::size_t megabytes = 16);
+
+        void resize(std::size_t megabytes);
+        void clear();
+        // Starts a new search : entries of older searches are replaced first.
+        void newSearch();
+
+        bool probe(Key, TTData&) const;
+        void store(Key, const TTData&);
+
+        std::size_t getBucketCount() const;
+        // Permille of sampled entries written during the current search.
+        int getUsage() const;
+
+    private:
+        struct Entry {
+            std::atomic<Key> key;
+            std::atomic<std::uint64_t> data;
+        };
+
+        struct alignas(64) Bucket {
+            Entry entries[4];
+        };
+
+        static std::uint64_t pack(const TTData&, unsigned age);
+        static TTData unpack(std::uint64_t data);
+        static unsigned getAge(std::uint64_t data);
+        static int getDepth(std::uint64_t data);
+
+        Bucket& getBucket(Key key) const;
+
+        std::unique_ptr<Bucket[]> buckets_;
+        std::size_t mask_ = 0;
+        unsigned age_ = 0;
+    };
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include "bitboard.h"
+
+namespace config {
+    using Key = std::uint64_t;
+
+    namespace detail {
+        struct ZobristKeys {
+            Key pieces[2][3][64];
+            Key blackToMove;
+        };
+
+        // splitmix64, run at compile time so the keys are identical on every build
+        constexpr Key nextZobristKey(Key& state)
+        {
+            Key key = (state += 0x9E3779B97F4A7C15ULL);
+            key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+            return key ^ (key >> 31);
+        }
+
+        constexpr ZobristKeys makeZobristKeys()
+        {
+            ZobristKeys keys{};
+            Key state = 0x5EED2024ULL;
+
+            for (auto& colorKeys : keys.pieces)
+                for (auto& typeKeys : colorKeys)
+                    for (Key& key : typeKeys)
+                        key = nextZobristKey(state);
+            keys.blackToMove = nextZobristKey(state);
+            return keys;
+        }
+    }
+
+    // One key per (color, piece type, square), plus one for black to move.
+    constexpr detail::ZobristKeys ZOBRIST = detail::makeZobristKeys();
+
+    constexpr Key zobristPiece(int color, int type, Square square)
+    {
+        return ZOBRIST.pieces[color][type][square];
+    }
+
+    constexpr Key ZOBRIST_BLACK_TO_MOVE = ZOBRIST.blackToMove;
+}